@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+#
+# Turns the binary serial log (see src/log.hpp) back into text.
+#
+#   python3 scripts/logdecode.py --port /dev/ttyUSB0     # needs pyserial
+#   python3 scripts/logdecode.py capture.bin
+#   cat capture.bin | python3 scripts/logdecode.py -
+#
+# Messages are looked up in --table, the logtable.json a build leaves in
+# .pio/build/<env>/, or else in a table built from src/ on the spot. Bytes
+# that do not frame up, such as boot ROM chatter, are passed through.
+import argparse
+import os
+import re
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import logtable  # noqa: E402
+
+SYNC = 0xb6
+LEVELS = "EWID"
+SPEC = re.compile(r"%(?:%|[-+ #0]*\d*(?:\.\d+)?(?:hh|h|ll|l|z)?([diuxXcpfFeEgGs]))")
+
+
+def crc8(data):
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xff if crc & 0x80 else (crc << 1) & 0xff
+    return crc
+
+
+def format_message(fmt, args):
+    """Rebuilds the text the way printf would, from the raw argument bytes."""
+    values = []
+    pos = 0
+    for m in SPEC.finditer(fmt):
+        kind = m.group(1)
+        if kind is None:
+            continue
+        if kind == "s":
+            if pos >= len(args):
+                values.append("<cut>")
+                continue
+            n = args[pos]
+            values.append(args[pos + 1:pos + 1 + n].decode("utf-8", "replace"))
+            pos += 1 + n
+            continue
+        if pos + 4 > len(args):
+            values.append(float("nan") if kind in "fFeEgG" else 0)
+            continue
+        if kind in "fFeEgG":
+            (v,) = struct.unpack_from("<f", args, pos)
+        elif kind in "di":
+            (v,) = struct.unpack_from("<i", args, pos)
+        else:
+            (v,) = struct.unpack_from("<I", args, pos)
+        values.append(v)
+        pos += 4
+    # Python's % takes C conversions as they are, minus p
+    return fmt.replace("%p", "%x") % tuple(values)
+
+
+class Decoder:
+    def __init__(self, table, out):
+        self.table = table
+        self.out = out
+        self.buf = bytearray()
+
+    def feed(self, data):
+        self.buf += data
+        while self.buf:
+            if self.buf[0] != SYNC:
+                end = self.buf.find(bytes([SYNC]))
+                end = len(self.buf) if end < 0 else end
+                self.out.write(self.buf[:end].decode("latin-1"))
+                del self.buf[:end]
+                continue
+            if len(self.buf) < 2:
+                return
+            n = self.buf[1]
+            if n < 9:
+                self.skip()
+                continue
+            if len(self.buf) < n + 3:
+                return
+            body = bytes(self.buf[2:2 + n])
+            if crc8(body) != self.buf[2 + n]:
+                self.skip()
+                continue
+            del self.buf[:n + 3]
+            self.frame(body)
+
+    def skip(self):
+        self.out.write(self.buf[:1].decode("latin-1"))
+        del self.buf[:1]
+
+    def frame(self, body):
+        level, ms, key = struct.unpack_from("<BII", body)
+        args = body[9:]
+        if key == 0:
+            self.out.write(args.decode("utf-8", "replace"))
+            return
+        entry = self.table.get(key)
+        if entry is None:
+            text = "unknown message %08x %s" % (key, args.hex())
+        else:
+            try:
+                text = format_message(entry["fmt"], args)
+            except (TypeError, ValueError) as e:
+                text = "%s <%s: %s>" % (entry["fmt"], e, args.hex())
+        letter = LEVELS[level] if level < len(LEVELS) else "?"
+        self.out.write("%u %s %s\n" % (ms, letter, text))
+
+
+def default_table():
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    return logtable.scan(os.path.join(root, "src"))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode the BGE binary serial log")
+    parser.add_argument("input", nargs="?", default="-", help="capture file, - for stdin")
+    parser.add_argument("--table", help="logtable.json from the build of the running firmware")
+    parser.add_argument("--port", help="read from this serial port instead")
+    parser.add_argument("--baud", type=int, default=115200)
+    args = parser.parse_args()
+
+    table = logtable.load(args.table) if args.table else default_table()
+    decoder = Decoder(table, sys.stdout)
+
+    if args.port:
+        import serial
+        source = serial.Serial(args.port, args.baud, timeout=0.1)
+        read = lambda: source.read(256)  # noqa: E731
+    elif args.input == "-":
+        source = sys.stdin.buffer
+        read = lambda: source.read1(256)  # noqa: E731
+    else:
+        source = open(args.input, "rb")
+        read = lambda: source.read(4096)  # noqa: E731
+
+    try:
+        while True:
+            data = read()
+            if not data:
+                if not args.port:
+                    break
+                continue
+            decoder.feed(data)
+            sys.stdout.flush()
+    except KeyboardInterrupt:
+        pass
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+#
+# Builds the message table for binary logs (see src/log.hpp) by scanning
+# the firmware sources for logError/logWarn/logInfo/logDebug calls. Each
+# format string is keyed by the same FNV-1a hash the firmware computes at
+# compile time.
+#
+#   python3 scripts/logtable.py [output.json]
+#
+# PlatformIO runs it before every build (extra_scripts in platformio.ini)
+# and writes logtable.json into the build directory. A hash collision
+# fails the build, since the decoder could not tell the messages apart.
+import json
+import os
+import re
+import sys
+
+LEVELS = ("Error", "Warn", "Info", "Debug")
+CALL = re.compile(r'\blog(%s)\(\s*((?:"(?:[^"\\]|\\.)*"\s*)+)' % "|".join(LEVELS))
+LITERAL = re.compile(r'"((?:[^"\\]|\\.)*)"')
+ESCAPES = {"n": "\n", "t": "\t", "r": "\r", "\\": "\\", '"': '"', "'": "'", "0": "\0"}
+
+
+def fnv1a(data):
+    h = 2166136261
+    for b in data:
+        h = ((h ^ b) * 16777619) & 0xffffffff
+    return h
+
+
+def unescape(text):
+    return re.sub(r"\\(.)", lambda m: ESCAPES.get(m.group(1), m.group(1)), text)
+
+
+def scan(src):
+    """Returns {id: {"fmt", "level", "file", "line"}} for every log call in src."""
+    table = {}
+    for name in sorted(os.listdir(src)):
+        if not name.endswith((".cpp", ".hpp", ".h")):
+            continue
+        with open(os.path.join(src, name), encoding="utf-8") as f:
+            code = f.read()
+        for m in CALL.finditer(code):
+            fmt = "".join(unescape(s) for s in LITERAL.findall(m.group(2)))
+            key = fnv1a(fmt.encode("utf-8"))
+            line = code.count("\n", 0, m.start()) + 1
+            if code[code.rfind("\n", 0, m.start()) + 1:m.start()].lstrip().startswith("//"):
+                continue  # an example in a comment
+            if key == 0:
+                raise SystemExit("%s:%d: log format hashes to 0, which is reserved" % (name, line))
+            if key in table and table[key]["fmt"] != fmt:
+                raise SystemExit("%s:%d: log format hash collides with %s:%d" %
+                                 (name, line, table[key]["file"], table[key]["line"]))
+            table[key] = {"fmt": fmt, "level": m.group(1).lower(), "file": name, "line": line}
+    return table
+
+
+def write(table, path):
+    with open(path, "w") as f:
+        json.dump({"%08x" % k: v for k, v in sorted(table.items())}, f, indent=1)
+
+
+def load(path):
+    with open(path) as f:
+        return {int(k, 16): v for k, v in json.load(f).items()}
+
+
+if __name__ == "__main__":
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    table = scan(os.path.join(root, "src"))
+    if len(sys.argv) > 1:
+        write(table, sys.argv[1])
+    else:
+        json.dump({"%08x" % k: v for k, v in sorted(table.items())}, sys.stdout, indent=1)
+        print()
+elif "Import" in globals():
+    # run from PlatformIO as a pre: extra script
+    Import("env")  # noqa: F821
+    out = os.path.join(env.subst("$BUILD_DIR"), "logtable.json")  # noqa: F821
+    os.makedirs(os.path.dirname(out), exist_ok=True)
+    write(scan(env.subst("$PROJECT_SRC_DIR")), out)  # noqa: F821
+    print("log table: %s" % out)
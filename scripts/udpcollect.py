@@ -0,0 +1,256 @@
+#!/usr/bin/env python3
+#
+# Collects UDP telemetry (src/udpsink.hpp) from any number of controllers.
+#
+# Every device gets a directory under --out holding one raw little-endian
+# file per column, appended as records arrive:
+#
+#   seq.u32  ms.u32  dome.f32  meat.f32  fan.f32  target.f32  recv.f64
+#
+# so numpy.fromfile(path, dtype) reads a column straight back. A bad
+# reading is stored as NaN. Sequence gaps, restarts, late or duplicate
+# records and probe faults go to events.csv next to the columns.
+#
+#   python3 scripts/udpcollect.py --out runs/today
+#   python3 scripts/udpcollect.py --selftest
+#
+# --selftest runs the collector against simulated devices on loopback and
+# checks what it wrote.
+import argparse
+import array
+import os
+import random
+import socket
+import struct
+import sys
+import tempfile
+import threading
+import time
+import zlib
+
+MAGIC = 0x4742
+VERSION = 1
+RECORD = struct.Struct("<HBBIIIhhHh")  # without the trailing CRC
+RECORD_SIZE = RECORD.size + 4
+DEFAULT_PORT = 4210
+FLUSH_SECONDS = 1.0
+
+COLUMNS = (("seq", "I"), ("ms", "I"), ("dome", "f"), ("meat", "f"),
+           ("fan", "f"), ("target", "f"), ("recv", "d"))
+EXTENSIONS = {"I": "u32", "f": "f32", "d": "f64"}
+
+
+PROBES = ("dome", "meat")
+
+
+def pack_record(device, seq, ms, dome, meat, fan, target, faults=0):
+    """Builds one record the way the firmware does, None for a bad reading."""
+    flags = (dome is not None) | (meat is not None) << 1 | faults << 2
+    body = RECORD.pack(MAGIC, VERSION, flags, device, seq, ms,
+                       round((dome or 0) * 10), round((meat or 0) * 10),
+                       round(fan * 100), round(target * 10))
+    return body + struct.pack("<I", zlib.crc32(body))
+
+
+def unpack_records(datagram):
+    """Yields decoded records and None for each one that fails its checks."""
+    for off in range(0, len(datagram) - RECORD_SIZE + 1, RECORD_SIZE):
+        body = datagram[off:off + RECORD.size]
+        (crc,) = struct.unpack_from("<I", datagram, off + RECORD.size)
+        fields = RECORD.unpack(body)
+        if fields[0] != MAGIC or fields[1] != VERSION or zlib.crc32(body) != crc:
+            yield None
+            continue
+        _, _, flags, device, seq, ms, dome, meat, fan, target = fields
+        nan = float("nan")
+        yield (device, seq, ms,
+               dome / 10.0 if flags & 1 else nan,
+               meat / 10.0 if flags & 2 else nan,
+               fan / 100.0, target / 10.0, flags >> 2 & 3)
+    if len(datagram) % RECORD_SIZE:
+        yield None
+
+
+class Device:
+    def __init__(self, root, device):
+        self.dir = os.path.join(root, "%06x" % device)
+        os.makedirs(self.dir, exist_ok=True)
+        self.columns = [array.array(code) for _, code in COLUMNS]
+        self.events = open(os.path.join(self.dir, "events.csv"), "a")
+        if self.events.tell() == 0:
+            self.events.write("recv,event,seq,detail\n")
+        self.last_seq = None
+        self.last_ms = None
+        self.records = 0
+        self.missing = 0
+        self.faults = 0
+
+    def event(self, recv, kind, seq, detail):
+        self.events.write("%.3f,%s,%d,%s\n" % (recv, kind, seq, detail))
+
+    def add(self, recv, seq, ms, dome, meat, fan, target, faults=0):
+        if self.last_seq is not None:
+            if seq < self.last_seq and ms < self.last_ms:
+                # the controller rebooted and started counting again
+                self.event(recv, "restart", seq, self.last_seq)
+            elif seq <= self.last_seq:
+                self.event(recv, "late", seq, self.last_seq)
+                return
+            elif seq > self.last_seq + 1:
+                lost = seq - self.last_seq - 1
+                self.missing += lost
+                self.event(recv, "gap", self.last_seq + 1, lost)
+        for bit, probe in enumerate(PROBES):
+            if (faults ^ self.faults) >> bit & 1:
+                self.event(recv, "fault" if faults >> bit & 1 else "clear", seq, probe)
+        self.faults = faults
+        self.last_seq = seq
+        self.last_ms = ms
+        self.records += 1
+        for column, value in zip(self.columns, (seq, ms, dome, meat, fan, target, recv)):
+            column.append(value)
+
+    def flush(self):
+        for (name, code), column in zip(COLUMNS, self.columns):
+            if column:
+                with open(os.path.join(self.dir, "%s.%s" % (name, EXTENSIONS[code])), "ab") as f:
+                    column.tofile(f)
+                del column[:]
+        self.events.flush()
+
+    def close(self):
+        self.flush()
+        self.events.close()
+
+
+class Collector:
+    def __init__(self, out, bind="0.0.0.0", port=DEFAULT_PORT):
+        self.out = out
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        self.sock.bind((bind, port))
+        self.sock.settimeout(0.2)
+        self.port = self.sock.getsockname()[1]
+        self.devices = {}
+        self.bad = 0
+        self.stopping = threading.Event()
+
+    def handle(self, datagram, recv):
+        for record in unpack_records(datagram):
+            if record is None:
+                self.bad += 1
+                continue
+            device = record[0]
+            if device not in self.devices:
+                self.devices[device] = Device(self.out, device)
+            self.devices[device].add(recv, *record[1:])
+
+    def run(self):
+        next_flush = time.time() + FLUSH_SECONDS
+        while not self.stopping.is_set():
+            try:
+                datagram, _ = self.sock.recvfrom(2048)
+                self.handle(datagram, time.time())
+            except socket.timeout:
+                pass
+            if time.time() >= next_flush:
+                next_flush = time.time() + FLUSH_SECONDS
+                for device in self.devices.values():
+                    device.flush()
+        for device in self.devices.values():
+            device.close()
+        self.sock.close()
+
+    def summary(self):
+        for device, d in sorted(self.devices.items()):
+            print("%06x: %d records, %d missing" % (device, d.records, d.missing))
+        if self.bad:
+            print("%d bad records" % self.bad)
+
+
+def simulate(port, devices=3, samples=200, batch=4, drop=0.05, seed=1):
+    """Sends from fake controllers to loopback, returns records dropped per device."""
+    rng = random.Random(seed)
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    dropped = {}
+    for d in range(devices):
+        device = 0xa00000 + d
+        dropped[device] = 0
+        for start in range(0, samples, batch):
+            packet = b"".join(
+                pack_record(device, seq, seq * 100, 450 + rng.uniform(-5, 5),
+                            None if seq % 50 == 0 else 160.0, rng.uniform(0, 100), 450,
+                            2 if 100 <= seq < 120 else 0)
+                for seq in range(start, min(start + batch, samples)))
+            if start > 0 and rng.random() < drop:
+                dropped[device] += len(packet) // RECORD_SIZE
+                continue
+            sock.sendto(packet, ("127.0.0.1", port))
+            time.sleep(0.0005)
+    # a corrupted datagram and a reboot of the first device
+    sock.sendto(b"\x42\x47" + bytes(RECORD_SIZE - 2), ("127.0.0.1", port))
+    sock.sendto(pack_record(0xa00000, 0, 5, 70.0, None, 0, 450), ("127.0.0.1", port))
+    sock.close()
+    return dropped
+
+
+def selftest():
+    import math
+    out = tempfile.mkdtemp(prefix="udpcollect-")
+    collector = Collector(out, "127.0.0.1", 0)
+    thread = threading.Thread(target=collector.run)
+    thread.start()
+    dropped = simulate(collector.port)
+    time.sleep(0.5)
+    collector.stopping.set()
+    thread.join()
+
+    ok = collector.bad == 1
+    for device, lost in dropped.items():
+        d = collector.devices[device]
+        seq = array.array("I")
+        with open(os.path.join(d.dir, "seq.u32"), "rb") as f:
+            seq.frombytes(f.read())
+        meat = array.array("f")
+        with open(os.path.join(d.dir, "meat.f32"), "rb") as f:
+            meat.frombytes(f.read())
+        with open(os.path.join(d.dir, "events.csv")) as f:
+            events = f.read()
+        restarted = device == 0xa00000
+        expect = 200 - lost + restarted
+        ok &= d.missing == lost and len(seq) == expect and len(meat) == expect
+        ok &= math.isnan(meat[0]) and meat[1] == 160.0
+        ok &= ("restart" in events) == restarted
+        ok &= ",fault," in events and ",clear," in events
+        print("%06x: %d records, %d missing of %d dropped" % (device, len(seq), d.missing, lost))
+    print("%d bad records, output in %s" % (collector.bad, out))
+    print("ok" if ok else "FAILED")
+    return 0 if ok else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Collect UDP telemetry from BGE controllers")
+    parser.add_argument("--out", default="telemetry", help="output directory")
+    parser.add_argument("--bind", default="0.0.0.0", help="address to listen on")
+    parser.add_argument("--port", type=int, default=DEFAULT_PORT)
+    parser.add_argument("--selftest", action="store_true",
+                        help="check the collector against simulated devices on loopback")
+    args = parser.parse_args()
+
+    if args.selftest:
+        return selftest()
+
+    collector = Collector(args.out, args.bind, args.port)
+    print("listening on %s:%d, writing %s" % (args.bind, collector.port, args.out))
+    try:
+        collector.run()
+    except KeyboardInterrupt:
+        collector.stopping.set()
+        for device in collector.devices.values():
+            device.close()
+    collector.summary()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,37 @@
+#!/usr/bin/env python3
+#
+# Regenerates src/dashboard_html.h from web/index.html.
+#
+# The dashboard page is served straight out of flash with
+# "Content-Encoding: gzip", so it is stored pre-compressed as a PROGMEM
+# byte array. Run this after editing web/index.html:
+#
+#   python3 scripts/webgz.py
+#
+import gzip
+import os
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SRC = os.path.join(ROOT, "web", "index.html")
+DST = os.path.join(ROOT, "src", "dashboard_html.h")
+
+with open(SRC, "rb") as f:
+    raw = f.read()
+
+# mtime=0 keeps the output stable so the header only changes with the page
+gz = gzip.compress(raw, compresslevel=9, mtime=0)
+
+lines = []
+for i in range(0, len(gz), 16):
+    lines.append("    " + ", ".join("0x%02x" % b for b in gz[i:i + 16]) + ",")
+
+with open(DST, "w") as f:
+    f.write("// generated by scripts/webgz.py from web/index.html - do not edit\n")
+    f.write("#ifndef BGE_DASHBOARD_HTML_H\n#define BGE_DASHBOARD_HTML_H\n\n")
+    f.write("#include <Arduino.h>\n\n")
+    f.write("// %d bytes, %d uncompressed\n" % (len(gz), len(raw)))
+    f.write("static const uint8_t dashboardHtmlGz[] PROGMEM = {\n")
+    f.write("\n".join(lines) + "\n};\n\n")
+    f.write("#endif // BGE_DASHBOARD_HTML_H\n")
+
+print("%s: %d -> %d bytes" % (os.path.relpath(DST, ROOT), len(raw), len(gz)))
@@ -0,0 +1,49 @@
+#include "bench.hpp"
+
+#include "fixed.hpp"
+#include "thermocouple.hpp"
+
+// keeps the compiler from folding the work away
+static volatile int32_t sinkInt;
+static volatile double  sinkDouble;
+
+template <typename F>
+static uint32_t measure(F body)
+{
+    uint32_t start = ESP.getCycleCount();
+    for (uint16_t i = 0; i < BENCH_RUNS; i++) {
+        body(i);
+    }
+    return (ESP.getCycleCount() - start) / BENCH_RUNS;
+}
+
+uint8_t benchRun(BenchResult *results)
+{
+    uint8_t n = 0;
+    char    buf[16];
+
+    // raw count to F the way the MAX6675 library does it
+    results[n++] = { "libraryF", measure([](uint16_t i) {
+                         volatile uint16_t v = 1600 + (i & 63);
+                         sinkDouble          = v * 0.25 * 9.0 / 5.0 + 32;
+                     }) };
+    results[n++] = { "calibrate", measure([](uint16_t i) {
+                         sinkInt = ktc.calibration.apply((int32_t) (1600 + (i & 63)) << KTC_FRACBITS);
+                     }) };
+    results[n++] = { "filter", measure([](uint16_t) { sinkInt = ktc.filtered(); }) };
+    results[n++] = { "toDouble", measure([](uint16_t i) { sinkDouble = tempToF(7200 + i); }) };
+    results[n++] = { "snprintf", measure([&buf](uint16_t i) {
+                         sinkInt = snprintf(buf, sizeof(buf), "%.1f", 450.0 + i * 0.0625);
+                     }) };
+    results[n++] = { "dtostrf", measure([&buf](uint16_t i) {
+                         dtostrf(450.0 + i * 0.0625, 1, 1, buf);
+                         sinkInt = buf[0];
+                     }) };
+    results[n++] = { "fmtFixed", measure([&buf](uint16_t i) {
+                         sinkInt = fmtFixed(buf, sizeof(buf), 7200 + i, TEMP_SHIFT, 1);
+                     }) };
+    results[n++] = { "tenths", measure([](uint16_t i) {
+                         sinkInt = roundShift((int32_t) (7200 + i) * 10, TEMP_SHIFT);
+                     }) };
+    return n;
+}
@@ -0,0 +1,23 @@
+#ifndef BGE_BENCH_HPP
+#define BGE_BENCH_HPP
+
+#include <Arduino.h>
+
+// Micro-benchmarks of the temperature path, run on the device through
+// GET /api/bench. Each case runs BENCH_RUNS times on varying input and
+// reports mean CPU cycles per run, the double and printf cases as the
+// path used to be next to the fixed-point ones that replaced them.
+
+#define BENCH_RUNS    256 // per case, keeps the whole set within a few ms
+#define BENCH_CASES   8
+#define BENCH_NAMEMAX 12 // characters in a case name
+
+struct BenchResult {
+    const char *name;
+    uint32_t    cycles;
+};
+
+// returns the number of results
+uint8_t benchRun(BenchResult *results);
+
+#endif // BGE_BENCH_HPP
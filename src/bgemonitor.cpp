@@ -1,9 +1,6 @@
 #include <Arduino.h>
 
 #include <ESP8266WiFi.h> // https://github.com/esp8266/Arduino
-#include <HttpClient.h>
-
-#include <max6675.h>
 
 // needed for library
 #include <DNSServer.h>
@@ -11,35 +8,67 @@
 #include <WiFiManager.h> // https://github.com/tzapu/WiFiManager
 
 #include <PID_v1.h>
+#include <Schedule.h>
 #include <Ticker.h>
-#include "ThingSpeak.h"
+
+#include "bgemonitor.hpp"
+#include "cascade.hpp"
+#include "cookstate.hpp"
+#include "dashboard.hpp"
+#include "domeloop.hpp"
+#include "fastwifi.hpp"
+#include "health.hpp"
+#include "httppost.hpp"
+#include "log.hpp"
+#include "model.hpp"
+#include "mpc.hpp"
+#include "mqttsink.hpp"
+#include "netwatch.hpp"
+#include "probe.hpp"
+#include "profile.hpp"
+#include "restapi.hpp"
+#include "sinks.hpp"
+#include "telemetry.hpp"
+#include "thermocouple.hpp"
+#include "udpsink.hpp"
 
 // Define Variables we'll be connecting to with PID
 double domeTarget, domeTempF, fanOutput;
+// the PID's share of fanOutput and the temperature it holds, see model.hpp
+double pidOutput, domeReference;
 double meatTarget, meatTempF;
+// the readings themselves, see fixed.hpp
+int16_t domeTemp = TEMP_NONE, meatTemp = TEMP_NONE;
 
 // for LED status
 Ticker ticker;
 
-// Specify the links and initial tuning parameters
+// Specify the links and initial tuning parameters; the dome overshoots
+// with these whatever the PID does at saturation, see domepid.hpp
 double aggKp = 4, aggKi = 0.2, aggKd = 1;
 double consKp = 1, consKi = 0.05, consKd = 0.25;
 double Kp = 2, Ki = 5, Kd = 1;
-PID domePID(&domeTempF, &fanOutput, &domeTarget, Kp, Ki, Kd, DIRECT);
+DomePid domePID(&domeTempF, &pidOutput, &domeReference, Kp, Ki, Kd, DIRECT);
 
 // for PID output control - vary the fan on/off by Output ms every x seconds
-#define FANWINDOW 10000
 unsigned long windowStartTime;
 
 // thermocouple max6675 interface
 int ktcSO  = 12;
 int ktcCS  = 13;
 int ktcCLK = 14;
-MAX6675 ktc(ktcCLK, ktcCS, ktcSO);
+Thermocouple ktc(ktcCLK, ktcCS, ktcSO);
+// meat probe on a second max6675, sharing SO and CLK
+int meatCS = 5;
+Thermocouple meatKtc(ktcCLK, meatCS, ktcSO);
 
 #define FAN 2
 int fanState = HIGH; // HIGH is off
 
+// seconds the config portal waits for a user when saved credentials exist
+#define WIFIPORTALTIMEOUT 180
+bool networkStarted = false;
+
 // text updates via http://textbelt.com/text -d number=4042164197 -d "message=text"
 
 // Name of the server we want to connect to
@@ -48,8 +77,13 @@ const char textHost[] = "textbelt.com";
 // that you want to download
 const char textPath[]   = "/text";
 const char textNumber[] = "4042164197";
+WiFiClient textClient;
+HttpPost   textPost(textClient);
 
 // do all your forward declarations
+bool controlTick();
+bool meatTick();
+void networkBegin();
 void setFan(int mode);
 double fahrenheit(double celcius);
 double Kelvin(double celsius);
@@ -59,18 +93,101 @@ void sendTextMessage(const char *phoneNumber, const char *message);
 void sendTextMessage(const char *phoneNumber, double message);
 void sendTextMessage(const char *phoneNumber, float message);
 
-// ThingSpeak Channel number and API key
-#define TSCHANNEL 1257165
-// const char * myWriteAPIKey    = "A7CCN9ZP8KOR8MZ7";
-#define TSAPIKEY  "XR8XPHTH5MX4AGQN"
-WiFiClient client;
-// TSINTERVAL = number of seconds between ThingSpeak updates
-#define TSINTERVAL 15
-unsigned long nextTSUpdate = 0;
 // TEXTINTERVAL = number of MINUTES between text updates
 #define TEXTINTERVAL 150
 unsigned long nextTextUpdate = 0;
 
+History history;
+
+// a pass blocks on at most a DNS lookup and a connect for each of the
+// ThingSpeak update and a text, and the sinks must not lose samples to it
+static_assert(TELEMETRY_RING * CONTROLINTERVAL > 2 * 2 * HTTPCONNECTTIMEOUT,
+              "the telemetry ring must outlast the HTTP connects of one pass");
+
+// telemetry consumers, fed from the control pass
+HistorySink    historySink;
+SerialCsvSink  serialSink;
+ThingSpeakSink thingSpeakSink;
+MqttSink       mqttSink;
+UdpSink        udpSink;
+
+
+// Reads the thermocouple and drives the fan. Runs as a recurrent scheduled
+// function, so it keeps going while setup() is blocked in the WiFiManager
+// portal or loop() waits on the network.
+bool controlTick()
+{
+    static unsigned long nextRead = 0;
+    static unsigned long lastPass = 0;
+
+    double dt = (millis() - lastPass) / 1000.0;
+    lastPass  = millis();
+
+    // the PID runs once per filtered reading, not once per pass
+    bool fresh = (long) (millis() - nextRead) >= 0;
+    if (fresh) {
+        nextRead = millis() + KTCINTERVAL;
+        fresh    = ktc.sample();
+    }
+    if (fresh) {
+        // a bad reading is dropped and the last good one stands, until the
+        // probe faults and there is nothing to stand on
+        int16_t reading = ktc.filtered();
+        fresh           = domeProbe.check(reading);
+        if (fresh) {
+            domeTemp = reading;
+        } else if (domeProbe.fault() != PROBE_OK) {
+            domeTemp = TEMP_NONE;
+        }
+        // the controllers work in double, converted once per reading
+        domeTempF = tempToF(domeTemp);
+    }
+
+    domeControl(fresh, domeProbe.fault() != PROBE_OK, dt);
+
+    if (millis() - windowStartTime > FANWINDOW) { // time to shift the Relay Window
+        windowStartTime += FANWINDOW;
+    }
+
+    if (fanOutput < millis() - windowStartTime) {
+      digitalWrite(FAN, LOW);
+      logDebug("FAN is ON\t%lu\t%lu", windowStartTime, millis());
+    } else {
+      digitalWrite(FAN, HIGH);
+      logDebug("FAN is off\t%lu\t%lu", windowStartTime, millis());
+    }
+
+    TelemetrySample sample;
+    sample.dome          = domeTemp;
+    sample.meat          = meatTemp;
+    sample.fan           = constrain(lround(fanOutput * (100.0 * FAN_SCALE / FANWINDOW)), 0L, 100L * FAN_SCALE);
+    sample.target        = tempFromF(domeTarget);
+    sample.heapFree      = min(health.heapFree, (uint32_t) UINT16_MAX);
+    sample.maxBlock      = health.maxBlock;
+    sample.fragmentation = health.fragmentation;
+    sample.flags         = (health.alert != HEALTH_OK ? TELEMETRY_HEAPALERT : 0) |
+                   (domeProbe.fault() != PROBE_OK ? TELEMETRY_DOMEFAULT : 0) |
+                   (meatProbe.fault() != PROBE_OK ? TELEMETRY_MEATFAULT : 0);
+    telemetryProduce(sample);
+    return true; // keep running
+}
+
+// Reads the meat probe and runs the cascade's outer loop. The meat moves
+// slowly, so this runs far less often than controlTick, and its filter
+// is a median over the last few readings.
+bool meatTick()
+{
+    meatKtc.sample();
+    int16_t reading = meatKtc.filtered();
+    if (meatProbe.check(reading)) {
+        meatTemp = reading;
+    } else if (meatProbe.fault() != PROBE_OK) {
+        meatTemp = TEMP_NONE;
+    }
+    meatTempF = tempToF(meatTemp);
+    cascadeUpdate();
+    return true; // keep running
+}
 
 // Celsius to Fahrenheit conversion
 double Fahrenheit(double celsius)
@@ -95,10 +212,9 @@ void tick()
 // gets called when WiFiManager enters configuration mode
 void configModeCallback(WiFiManager *myWiFiManager)
 {
-    Serial.println("Entered config mode");
-    Serial.println(WiFi.softAPIP());
     // if you used auto generated SSID, print it
-    Serial.println(myWiFiManager->getConfigPortalSSID());
+    logInfo("Entered config mode, %s on %s", myWiFiManager->getConfigPortalSSID().c_str(),
+            WiFi.softAPIP().toString().c_str());
     // entered config mode, make led toggle faster
     ticker.attach(0.2, tick);
 }
@@ -106,19 +222,24 @@ void configModeCallback(WiFiManager *myWiFiManager)
 // sendTextMessage sends message to a given phoneNumber via an http POST
 void sendTextMessage(const char *phoneNumber, const char *message)
 {
-  const char phoneHeader[]   = "number=%s&";
-  const char messageHeader[] = "message";
-
-  char httpData[100] = "";
-  WiFiClient c;
-  HttpClient http(c);
-  http.beginRequest();
-  http.startRequest(textHost, 80, textPath, HTTP_METHOD_POST, HTTP_HEADER_USER_AGENT);
-  unsigned int n=sprintf (httpData, "number=%s&message=%s", textNumber, "message");
-  Serial.println(httpData);
-  c.print(httpData);
-  http.endRequest();
+  char number[24], text[100], httpData[140];
+  if (!netCanSend()) {
+    return;
+  }
+  if (urlEncode(number, sizeof(number), phoneNumber) < 0 || urlEncode(text, sizeof(text), message) < 0) {
+    logWarn("text message too long");
+    return;
+  }
+  int n = snprintf(httpData, sizeof(httpData), "number=%s&message=%s", number, text);
+  logDebug("%s", httpData);
+  if (!textPost.start(textHost, textPath, httpData, n)) {
+    logWarn("text message dropped, the last one is still sending");
+  }
+}
 
+void sendAlert(const char *message)
+{
+    sendTextMessage(textNumber, message);
 }
 
 // This version does the same for a double message
@@ -149,7 +270,8 @@ void sendTextMessage(const char *phoneNumber, float message)
 void setup()
 {
     // put your setup code here, to run once:
-    Serial.begin(9600);
+    logBegin();
+    healthBegin();
 
     // set led pin as output
     pinMode(LED_BUILTIN, OUTPUT);
@@ -157,37 +279,10 @@ void setup()
     ticker.attach(0.6, tick);
 
     pinMode(FAN, OUTPUT);
-
-    // WiFiManager
-    // Local intialization. Once its business is done, there is no need to keep it around
-    WiFiManager wifiManager;
-
-    // reset settings - for testing only
-    // wifiManager.resetSettings();
-
-    // set callback that gets called when connecting to previous WiFi fails, and enters Access Point mode
-    wifiManager.setAPCallback(configModeCallback);
-
-    // fetches ssid and pass and tries to connect
-    // if it does not connect it starts an access point with the specified name
-    // here  "AutoConnectAP"
-    // and goes into a blocking loop awaiting configuration
-    if (!wifiManager.autoConnect()) {
-        Serial.println("failed to connect and hit timeout");
-        // reset and try again, or maybe put it to deep sleep
-        ESP.reset();
-        delay(1000);
-    }
-
-    // if you get here you have connected to the WiFi
-    Serial.println("connected...yeey :)");
-    ticker.detach();
-
-    ticker.attach(5, tick);
-
-    // keep LED on
-    digitalWrite(LED_BUILTIN, LOW);
-    sendTextMessage(textNumber, "hello");
+    ktc.begin();
+    meatKtc.begin();
+    // the meat is read every 5 s, a median of three is plenty
+    meatKtc.setFilter(3, 1, 1);
 
     // initialize the variables we're linked to
     domeTarget = 450;
@@ -196,59 +291,115 @@ void setup()
     domePID.SetOutputLimits(0, FANWINDOW);
 
     // turn the PID on
-    domePID.SetMode(AUTOMATIC);
+    domeAutomatic();
 
     domePID.SetTunings(aggKp, aggKi, aggKd);
     // domePID.SetTunings(consKp, consKi, consKd);
 
-    ThingSpeak.begin(client);
+    // controlTick paces the PID by fresh readings
+    domePID.SetSampleTime(0);
+    domePID.SetDerivativeFilter(DERIVFILTER);
+
+    // pick up where we left off if this is a reset mid-cook
+    calibrationBegin();
+    domeTemp  = ktc.read();
+    meatTemp  = meatKtc.read();
+    domeTempF = tempToF(domeTemp);
+    meatTempF = tempToF(meatTemp);
+    cookStateBegin();
+    probeBegin();
+    cascadeBegin();
+    profileBegin();
+
+    telemetryAddSink(&historySink);
+    telemetryAddSink(&serialSink);
+    telemetryAddSink(&thingSpeakSink);
+    telemetryAddSink(&mqttSink);
+    telemetryAddSink(&udpSink);
+
+    // the fire is under control from here on, whatever the network does
+    schedule_recurrent_function_us(controlTick, CONTROLINTERVAL * 1000);
+    schedule_recurrent_function_us(meatTick, CASCADE_INTERVAL * 1000L);
+
+    // rejoin the AP we were on last time before falling back to a full scan
+    // and, if that fails too, the config portal
+    unsigned long connectStart = millis();
+    if (!wifiFastConnect()) {
+        // WiFiManager
+        // Local intialization. Once its business is done, there is no need to keep it around
+        WiFiManager wifiManager;
+
+        // reset settings - for testing only
+        // wifiManager.resetSettings();
+
+        // set callback that gets called when connecting to previous WiFi fails, and enters Access Point mode
+        wifiManager.setAPCallback(configModeCallback);
+
+        // without saved credentials the portal is the only way forward, so it
+        // stays up; otherwise give up after a while and let the SDK keep
+        // retrying the saved AP in the background
+        if (WiFi.SSID().length() > 0) {
+            wifiManager.setConfigPortalTimeout(WIFIPORTALTIMEOUT);
+        }
+
+        // fetches ssid and pass and tries to connect
+        // if it does not connect it starts an access point with the specified name
+        // here  "AutoConnectAP"
+        // and goes into a blocking loop awaiting configuration
+        if (!wifiManager.autoConnect()) {
+            logWarn("failed to connect and hit timeout, running offline");
+            WiFi.mode(WIFI_STA);
+            WiFi.begin();
+        }
+
+        wifiConnectMs = millis() - connectStart;
+        logInfo("full connect in %lums", wifiConnectMs);
+    }
+    ticker.detach();
 } // setup
 
-void loop()
+// telemetry setup, once the first connection is up
+void networkBegin()
 {
-    // Write to ThingSpeak. There are up to 8 fields in a channel, allowing you to store up to 8 different
-    // pieces of information in a channel.  Here, we write to field 1.
+    // if you get here you have connected to the WiFi
+    logInfo("connected...yeey :)");
+    wifiCacheSave();
 
-    domeTempF = ktc.readFarenheit();
-    domePID.Compute();
+    ticker.attach(5, tick);
 
-    if (millis() - windowStartTime > FANWINDOW) { // time to shift the Relay Window
-        windowStartTime += FANWINDOW;
+    // keep LED on
+    digitalWrite(LED_BUILTIN, LOW);
+    sendTextMessage(textNumber, "hello");
+
+    apiBegin();
+    dashboardBegin();
+}
+
+void loop()
+{
+    // local bookkeeping, with or without a network
+    cookStateLoop();
+    profileLoop();
+    healthLoop();
+    probeLoop();
+
+    netWatchLoop();
+    if (netLinkUp() && !networkStarted) {
+        networkStarted = true;
+        networkBegin();
     }
 
-    if (fanOutput < millis() - windowStartTime) {
-      digitalWrite(FAN, LOW);
-      Serial.printf("FAN is ON\t%d\t%d\n", windowStartTime, millis());
-    } else {
-      digitalWrite(FAN, HIGH);
-      Serial.printf("FAN is off\t%d\t%d\n", windowStartTime, millis());
+    // sinks that need the network wait for it, control carries on regardless
+    telemetryLoop(netLinkUp());
+    if (!netLinkUp()) {
+        return;
     }
-    delay(100);
-
-    if (millis() >= nextTSUpdate) {
-      nextTSUpdate = millis() + TSINTERVAL * 1000; // next time we should update ThingSpeak
-      Serial.print("Dome F = ");
-      Serial.print(domeTempF);
-      Serial.print("\tdomeTarget = ");
-      Serial.print(domeTarget);
-      Serial.print("\t Meat F = ");
-      Serial.print(meatTempF);
-      Serial.print("\t fanOutput = ");
-      Serial.print(fanOutput);
-      Serial.println("");
-
-      // Check if any reads failed and exit early (to try again).
-      if (isnan(domeTempF) || isnan(meatTempF) || isnan(fanOutput)) {
-          Serial.println("Error: bad data!");
-          delay(1000);
-      } else {
-          ThingSpeak.setField(1, (float) domeTempF);
-          ThingSpeak.setField(2, (float) meatTempF);
-          ThingSpeak.setField(3, (float) fanOutput);
-
-          ThingSpeak.writeFields(TSCHANNEL, TSAPIKEY);
-        //  delay(60 * 1000); // ThingSpeak will only accept updates every 15 seconds.
-      }
+
+    dashboardLoop();
+
+    int textStatus = textPost.poll();
+    if (textStatus != HTTP_PENDING) {
+        netSendResult(textStatus > 0);
     }
 
     // if (millis() >= nextTextUpdate) {
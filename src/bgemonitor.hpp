@@ -0,0 +1,55 @@
+#ifndef BGE_MONITOR_HPP
+#define BGE_MONITOR_HPP
+
+#include <Arduino.h>
+#include "domepid.hpp"
+#include "fixed.hpp"
+
+#include "history.hpp"
+
+// for PID output control - vary the fan on/off by Output ms every x seconds
+#define FANWINDOW 10000
+
+// ms between control passes, and so between telemetry samples
+#define CONTROLINTERVAL 100
+
+// ms between dome samples; the MAX6675 takes up to 220 ms to convert and
+// reading it sooner only returns the last value again. The controller sees
+// a filtered reading every KTC_DECIMATE samples, see thermocouple.hpp.
+#define KTCINTERVAL 250
+
+// s, time constant of the low-pass on domePID's derivative
+#define DERIVFILTER 2.0
+
+// range the dome setpoint may be changed to at runtime
+#define DOMEMIN 100
+#define DOMEMAX 750
+
+// largest domePID gain accepted at runtime; at this kp a 1 F error already
+// swings the fan by a tenth of FANWINDOW
+#define GAINMAX 1000
+
+// Controller variables, owned by bgemonitor.cpp and shared with the
+// dashboard and API modules
+extern double domeTarget, domeTempF, fanOutput;
+// the PID's share of fanOutput and the temperature it holds, see model.hpp
+extern double pidOutput, domeReference;
+extern double meatTarget, meatTempF;
+// the readings in 1/16 F, TEMP_NONE without one; domeTempF and meatTempF
+// follow them for the controllers
+extern int16_t domeTemp, meatTemp;
+extern DomePid domePID;
+// start of the current fan on/off window, in millis()
+extern unsigned long windowStartTime;
+
+// 1 Hz cook history kept in RAM
+extern History history;
+
+// hand the fan to domePID, seeding it so fanOutput does not jump; in
+// domeloop.cpp
+void domeAutomatic();
+
+// text the cook's phone, when the network allows
+void sendAlert(const char *message);
+
+#endif // BGE_MONITOR_HPP
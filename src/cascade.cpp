@@ -0,0 +1,80 @@
+#include "cascade.hpp"
+
+#include <LittleFS.h>
+
+#include "bgemonitor.hpp"
+#include "crc32.hpp"
+#include "log.hpp"
+
+CascadeConfig cascade;
+DomePid       meatPID(&meatTempF, &domeTarget, &meatTarget, CASCADE_KP, CASCADE_KI, CASCADE_KD, DIRECT);
+
+static void apply()
+{
+    meatTarget = cascade.meatTarget;
+    meatPID.SetOutputLimits(cascade.domeMin, cascade.domeMax);
+    // MANUAL first so AUTOMATIC reseeds the integrator from domeTarget
+    meatPID.SetMode(MANUAL);
+    if (cascade.enabled) {
+        meatPID.SetMode(AUTOMATIC);
+    }
+}
+
+static void save()
+{
+    cascade.magic = CASCADE_MAGIC;
+    cascade.crc   = crc32Of(&cascade, offsetof(CascadeConfig, crc));
+
+    File f = LittleFS.open(CASCADE_FILE, "w");
+    if (f) {
+        f.write((const uint8_t *) &cascade, sizeof(cascade));
+        f.close();
+    }
+}
+
+void cascadeBegin()
+{
+    meatPID.SetSampleTime(0);
+
+    File f = LittleFS.open(CASCADE_FILE, "r");
+    bool ok = f && f.read((uint8_t *) &cascade, sizeof(cascade)) == sizeof(cascade) &&
+              cascade.magic == CASCADE_MAGIC && cascade.crc == crc32Of(&cascade, offsetof(CascadeConfig, crc));
+    if (f) {
+        f.close();
+    }
+    if (!ok) {
+        memset(&cascade, 0, sizeof(cascade));
+        cascade.meatTarget = 203;
+        cascade.domeMin    = 225;
+        cascade.domeMax    = 450;
+    }
+    apply();
+    if (cascade.enabled) {
+        logInfo("cascade on, meat %.0f, dome %.0f-%.0f", cascade.meatTarget, cascade.domeMin, cascade.domeMax);
+    }
+}
+
+void cascadeUpdate()
+{
+    // a missing probe holds the dome where it is
+    if (cascade.enabled && !isnan(meatTempF)) {
+        meatPID.Compute();
+    }
+}
+
+const char *cascadeConfigure(bool enabled, float meatTarget, float domeMin, float domeMax)
+{
+    if (!(domeMin >= DOMEMIN && domeMax <= DOMEMAX && domeMin <= domeMax)) {
+        return "dome range must lie within 100-750";
+    }
+    if (!(meatTarget >= 32 && meatTarget < domeMax)) {
+        return "meat target must be above freezing and below the dome ceiling";
+    }
+    cascade.enabled    = enabled;
+    cascade.meatTarget = meatTarget;
+    cascade.domeMin    = domeMin;
+    cascade.domeMax    = domeMax;
+    apply();
+    save();
+    return NULL;
+}
@@ -0,0 +1,53 @@
+#ifndef BGE_CASCADE_HPP
+#define BGE_CASCADE_HPP
+
+#include <Arduino.h>
+
+#include "domepid.hpp"
+
+// Cascade control. A slow outer loop on the meat probe moves domeTarget
+// between a floor and a user ceiling, and domePID keeps tracking whatever
+// it is set to. Far from done the dome runs at the ceiling; as the meat
+// closes in the setpoint comes down, so the cook finishes sooner than at a
+// fixed dome without coasting past the target.
+//
+// The settings live in flash and survive resets. domeTarget itself is
+// restored with the rest of the cook state, and the outer loop picks up
+// from it without a bump.
+//
+// meatTick paces the outer loop: meatPID has a sample time of 0 and
+// measures the time between passes, so a late or early pass is neither
+// skipped nor given the wrong integral.
+
+#define CASCADE_FILE     "/cascade.bin"
+#define CASCADE_INTERVAL 5000 // ms between meat readings and outer loop passes
+#define CASCADE_MAGIC    0x43534331
+
+// outer loop tunings, dome degrees per degree of meat error
+#define CASCADE_KP 4.0
+#define CASCADE_KI 0.0005
+#define CASCADE_KD 0.0
+
+struct CascadeConfig {
+    uint32_t magic;
+    uint8_t  enabled;
+    uint8_t  reserved[3];
+    float    meatTarget;
+    float    domeMin; // floor for domeTarget
+    float    domeMax; // ceiling for domeTarget
+    uint32_t crc;
+};
+
+extern CascadeConfig cascade;
+extern DomePid       meatPID;
+
+// load the settings, call after cookStateBegin()
+void cascadeBegin();
+
+// run the outer loop on a new meat reading, from the meat task
+void cascadeUpdate();
+
+// validate, apply and store new settings; NULL or an error message
+const char *cascadeConfigure(bool enabled, float meatTarget, float domeMin, float domeMax);
+
+#endif // BGE_CASCADE_HPP
@@ -0,0 +1,141 @@
+#include "cooklog.hpp"
+
+#include <LittleFS.h>
+
+#include "crc32.hpp"
+
+#define COOKLOG_VERSION 1
+
+FileCookLogStorage::FileCookLogStorage(const char *path, const char *previousPath) :
+    path(path), previousPath(previousPath)
+{
+}
+
+size_t FileCookLogStorage::size(bool previous)
+{
+    File f = LittleFS.open(previous ? previousPath : path, "r");
+    if (!f) {
+        return 0;
+    }
+    size_t n = f.size();
+    f.close();
+    return n;
+}
+
+bool FileCookLogStorage::read(bool previous, size_t offset, uint8_t *buf, size_t len)
+{
+    File f = LittleFS.open(previous ? previousPath : path, "r");
+    if (!f) {
+        return false;
+    }
+    bool ok = f.seek(offset, SeekSet) && f.read(buf, len) == len;
+    f.close();
+    return ok;
+}
+
+bool FileCookLogStorage::append(const uint8_t *buf, size_t len)
+{
+    File f = LittleFS.open(path, "a");
+    if (!f) {
+        return false;
+    }
+    bool ok = f.write(buf, len) == len;
+    // close commits the write, up to here a power loss leaves the old file
+    f.close();
+    return ok;
+}
+
+bool FileCookLogStorage::rotate()
+{
+    LittleFS.remove(previousPath);
+    return LittleFS.rename(path, previousPath);
+}
+
+bool FileCookLogStorage::clear()
+{
+    LittleFS.remove(previousPath);
+    LittleFS.remove(path);
+    return true;
+}
+
+CookLog::CookLog(CookLogStorage &storage) : storage(storage), buffered(0), nextSeq(0), pagesWritten(0)
+{
+}
+
+bool CookLog::valid(const CookRecord &record)
+{
+    return record.magic == COOKLOG_MAGIC && record.version == COOKLOG_VERSION &&
+           record.crc == crc32Of(&record, offsetof(CookRecord, crc));
+}
+
+bool CookLog::recoverFrom(bool previous, CookRecord &record)
+{
+    // a torn write can leave a partial record at the end, ignore it
+    size_t count = storage.size(previous) / sizeof(CookRecord);
+
+    for (size_t i = 0; i < COOKLOG_MAXSCAN && i < count; i++) {
+        size_t offset = (count - 1 - i) * sizeof(CookRecord);
+        if (storage.read(previous, offset, (uint8_t *) &record, sizeof(record)) && valid(record)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CookLog::recover(CookRecord &record)
+{
+    // the current log starts with a fresh checkpoint after each rotation,
+    // so the previous one only matters if that was lost too
+    bool found = recoverFrom(false, record) || recoverFrom(true, record);
+    if (found) {
+        nextSeq = record.seq + 1;
+    }
+    return found;
+}
+
+void CookLog::append(CookRecord &record)
+{
+    record.magic   = COOKLOG_MAGIC;
+    record.version = COOKLOG_VERSION;
+    record.seq     = nextSeq++;
+    record.crc     = crc32Of(&record, offsetof(CookRecord, crc));
+
+    const uint8_t capacity = sizeof(page) / sizeof(page[0]);
+    if (buffered == capacity && !flush()) {
+        // flash keeps failing, the oldest unwritten record is worth least
+        memmove(&page[0], &page[1], (capacity - 1) * sizeof(CookRecord));
+        buffered--;
+    }
+    page[buffered++] = record;
+    if (buffered == capacity) {
+        flush();
+    }
+}
+
+bool CookLog::flush()
+{
+    if (buffered == 0) {
+        return true;
+    }
+
+    size_t len  = buffered * sizeof(CookRecord);
+    size_t size = storage.size(false);
+    // a failed write may have left part of a record behind, which would
+    // misalign everything after it, so that also starts a new file
+    if (size + len > COOKLOG_MAXSIZE || size % sizeof(CookRecord) != 0) {
+        storage.rotate();
+    }
+    if (!storage.append((const uint8_t *) page, len)) {
+        // keep the records, the next flush tries again
+        return false;
+    }
+    buffered = 0;
+    pagesWritten++;
+    return true;
+}
+
+void CookLog::clear()
+{
+    storage.clear();
+    buffered = 0;
+}
@@ -0,0 +1,98 @@
+#ifndef BGE_COOKLOG_HPP
+#define BGE_COOKLOG_HPP
+
+#include <Arduino.h>
+
+// Append-only log of controller checkpoints in flash, used to pick a cook
+// back up after a reset.
+//
+// Records are fixed size with their own CRC, so a write torn by a power
+// loss only costs the records it was carrying: recovery walks back from the
+// end of the log to the newest record that still checks out. Records are
+// buffered in RAM and written a flash page at a time to keep wear down.
+
+#define COOKLOG_MAGIC    0xC00C
+#define COOKLOG_PAGE     256           // flash page, one write
+#define COOKLOG_MAXSIZE  (64 * 1024L)  // rotate the log beyond this
+#define COOKLOG_MAXSCAN  64            // records to search back for a good one
+
+struct CookRecord {
+    uint16_t magic;
+    uint8_t  version;
+    uint8_t  mode;        // PID AUTOMATIC or MANUAL
+    uint32_t seq;
+    uint32_t cookSeconds; // time since the cook was started
+    float    setpoint;
+    float    integrator;  // controller output the integrator is seeded with
+    float    domeF;
+    float    meatF;
+    uint32_t crc;         // over everything above
+};
+
+static_assert(sizeof(CookRecord) == 32, "cook records must stay 32 bytes");
+static_assert(COOKLOG_PAGE % sizeof(CookRecord) == 0, "records must not straddle pages");
+
+// where the log bytes live; flash in the firmware, a simulated device in
+// host tests
+class CookLogStorage
+{
+  public:
+    virtual ~CookLogStorage() {}
+
+    // byte length of the current and previous (rotated) log
+    virtual size_t size(bool previous) = 0;
+    virtual bool   read(bool previous, size_t offset, uint8_t *buf, size_t len) = 0;
+    virtual bool   append(const uint8_t *buf, size_t len) = 0;
+    // current log becomes the previous one, the current one starts empty
+    virtual bool rotate() = 0;
+    // drop both logs
+    virtual bool clear() = 0;
+};
+
+// storage on the LittleFS partition, which is power-loss safe on its own
+class FileCookLogStorage : public CookLogStorage
+{
+  public:
+    FileCookLogStorage(const char *path, const char *previousPath);
+
+    size_t size(bool previous);
+    bool   read(bool previous, size_t offset, uint8_t *buf, size_t len);
+    bool   append(const uint8_t *buf, size_t len);
+    bool   rotate();
+    bool   clear();
+
+  private:
+    const char *path;
+    const char *previousPath;
+};
+
+class CookLog
+{
+  public:
+    CookLog(CookLogStorage &storage);
+
+    // newest intact record in the log, false when there is none
+    bool recover(CookRecord &record);
+
+    // queue a record, written out once a page is full or on flush()
+    void append(CookRecord &record);
+    bool flush();
+
+    // forget everything, for the start of a new cook
+    void clear();
+
+    uint32_t written() const { return pagesWritten; }
+    uint8_t  pending() const { return buffered; }
+
+  private:
+    bool recoverFrom(bool previous, CookRecord &record);
+    static bool valid(const CookRecord &record);
+
+    CookLogStorage &storage;
+    CookRecord      page[COOKLOG_PAGE / sizeof(CookRecord)];
+    uint8_t         buffered;
+    uint32_t        nextSeq;
+    uint32_t        pagesWritten;
+};
+
+#endif // BGE_COOKLOG_HPP
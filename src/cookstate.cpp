@@ -0,0 +1,172 @@
+#include "cookstate.hpp"
+
+#include <LittleFS.h>
+
+#include "bgemonitor.hpp"
+#include "cooklog.hpp"
+#include "log.hpp"
+#include "crc32.hpp"
+#include "rtcmem.hpp"
+
+// controller state kept in RTC memory
+struct WarmState {
+    uint32_t magic;
+    uint32_t cookSeconds;
+    float    setpoint;
+    float    integrator;
+    float    lastInput;
+    uint16_t windowPhase; // ms into the current fan window
+    uint8_t  mode;
+    uint8_t  reserved;
+    uint32_t crc;
+};
+
+static_assert(sizeof(WarmState) % 4 == 0, "RTC memory is written in 4 byte blocks");
+
+static FileCookLogStorage cookStorage("/cook.log", "/cook.old");
+static CookLog            cookLog(cookStorage);
+
+static uint32_t      cookBase = 0;      // cook seconds at cookBaseMillis
+static unsigned long cookBaseMillis = 0;
+static unsigned long nextWarmCheckpoint = 0;
+static unsigned long nextCheckpoint = 0;
+static unsigned long nextFlush = 0;
+static bool          logReady = false;
+
+uint32_t cookSeconds()
+{
+    return cookBase + (millis() - cookBaseMillis) / 1000;
+}
+
+static void checkpoint()
+{
+    CookRecord record;
+
+    record.mode        = domePID.GetMode();
+    record.cookSeconds = cookSeconds();
+    record.setpoint    = domeTarget;
+    // near steady state the integral is the output itself, and
+    // domeAutomatic() seeds the integral from fanOutput
+    record.integrator  = fanOutput;
+    record.domeF       = domeTempF;
+    record.meatF       = meatTempF;
+    cookLog.append(record);
+}
+
+static void warmCheckpoint()
+{
+    WarmState warm;
+
+    warm.magic       = RTC_WARMSTATE_MAGIC;
+    warm.cookSeconds = cookSeconds();
+    warm.setpoint    = domeTarget;
+    warm.integrator  = fanOutput;
+    warm.lastInput   = domeTempF;
+    warm.windowPhase = (millis() - windowStartTime) % FANWINDOW;
+    warm.mode        = domePID.GetMode();
+    warm.reserved    = 0;
+    warm.crc         = crc32Of(&warm, offsetof(WarmState, crc));
+    ESP.rtcUserMemoryWrite(RTC_WARMSTATE_BLOCK, (uint32_t *) &warm, sizeof(warm));
+}
+
+static bool readWarmState(WarmState &warm)
+{
+    // RTC memory is random after power-on, the CRC would catch that too
+    if (ESP.getResetInfoPtr()->reason == REASON_DEFAULT_RST) {
+        return false;
+    }
+    return ESP.rtcUserMemoryRead(RTC_WARMSTATE_BLOCK, (uint32_t *) &warm, sizeof(warm)) &&
+           warm.magic == RTC_WARMSTATE_MAGIC && warm.crc == crc32Of(&warm, offsetof(WarmState, crc));
+}
+
+static void resume(const char *from, uint32_t seconds, float setpoint, float integrator, uint8_t mode)
+{
+    if (setpoint >= DOMEMIN && setpoint <= DOMEMAX) {
+        domeTarget = setpoint;
+    }
+    cookBase       = seconds;
+    cookBaseMillis = millis();
+
+    if (!isnan(integrator)) {
+        domePID.SetMode(MANUAL);
+        fanOutput = constrain(integrator, 0.0f, (float) FANWINDOW);
+        if (mode == AUTOMATIC) {
+            // bumpless: the integrator starts from the restored output and
+            // the derivative from domeTempF
+            domeAutomatic();
+        }
+    }
+
+    logInfo("resumed cook from %s at %us, target %.0f, fan %.0f%%", from, cookBase, domeTarget,
+                  fanOutput * 100.0 / FANWINDOW);
+}
+
+void cookStateBegin()
+{
+    WarmState  warm;
+    CookRecord record;
+
+    cookBaseMillis = millis();
+    logReady       = LittleFS.begin();
+    if (!logReady) {
+        logWarn("cook log: no filesystem, not persisting");
+    }
+    // recover even when RTC wins, it also continues the record sequence
+    bool inFlash = logReady && cookLog.recover(record);
+
+    if (readWarmState(warm)) {
+        // carry on mid-window too, so the fan does not restart its duty cycle
+        windowStartTime = millis() - warm.windowPhase;
+        if (isnan(domeTempF)) {
+            domeTempF = warm.lastInput;
+            domeTemp  = tempFromF(domeTempF);
+        }
+        resume("RTC", warm.cookSeconds, warm.setpoint, warm.integrator, warm.mode);
+    } else if (inFlash) {
+        resume("flash", record.cookSeconds, record.setpoint, record.integrator, record.mode);
+    }
+
+    nextWarmCheckpoint = millis() + COOKSTATE_RTCINTERVAL;
+    nextCheckpoint     = millis() + COOKSTATE_INTERVAL * 1000;
+    nextFlush          = millis() + COOKSTATE_FLUSH * 1000;
+}
+
+void cookStateLoop()
+{
+    if (millis() >= nextWarmCheckpoint) {
+        nextWarmCheckpoint = millis() + COOKSTATE_RTCINTERVAL;
+        warmCheckpoint();
+    }
+    if (!logReady) {
+        return;
+    }
+    if (millis() >= nextCheckpoint) {
+        nextCheckpoint = millis() + COOKSTATE_INTERVAL * 1000;
+        checkpoint();
+    }
+    if (millis() >= nextFlush) {
+        nextFlush = millis() + COOKSTATE_FLUSH * 1000;
+        cookLog.flush();
+    }
+}
+
+void cookStateSave()
+{
+    warmCheckpoint();
+    if (!logReady) {
+        return;
+    }
+    checkpoint();
+    cookLog.flush();
+    nextFlush = millis() + COOKSTATE_FLUSH * 1000;
+}
+
+void cookStateNew()
+{
+    cookBase       = 0;
+    cookBaseMillis = millis();
+    if (logReady) {
+        cookLog.clear();
+    }
+    cookStateSave();
+}
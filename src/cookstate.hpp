@@ -0,0 +1,34 @@
+#ifndef BGE_COOKSTATE_HPP
+#define BGE_COOKSTATE_HPP
+
+#include <Arduino.h>
+
+// Checkpoints the controller and restores it after a reset, so the fire is
+// not mismanaged while the PID relearns. A checkpoint goes to RTC memory
+// every few seconds, which covers soft resets, WDT and exceptions; the
+// flash cook log is the fallback after a power cycle.
+
+// ms between RTC checkpoints
+#define COOKSTATE_RTCINTERVAL 2000
+// seconds between flash checkpoints
+#define COOKSTATE_INTERVAL 15
+// seconds a partly filled page may wait before it is written anyway
+#define COOKSTATE_FLUSH    120
+
+// mount the filesystem and restore the newest checkpoint, call once the
+// PID is configured and domeTempF holds a first reading
+void cookStateBegin();
+
+// checkpoint and flush when due, call from loop()
+void cookStateLoop();
+
+// checkpoint and write to flash right away, after a setting changed
+void cookStateSave();
+
+// forget the previous cook and restart the cook clock
+void cookStateNew();
+
+// seconds since the cook started, carried across resets
+uint32_t cookSeconds();
+
+#endif // BGE_COOKSTATE_HPP
@@ -0,0 +1,11 @@
+#ifndef BGE_CRC32_HPP
+#define BGE_CRC32_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+// standard CRC-32 (IEEE 802.3, as zlib). Pass the previous result as crc to
+// continue over several buffers. Plain C++ so host tools can share it.
+uint32_t crc32Of(const void *data, size_t len, uint32_t crc = 0);
+
+#endif // BGE_CRC32_HPP
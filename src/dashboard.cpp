@@ -0,0 +1,97 @@
+#include "dashboard.hpp"
+
+#include "bgemonitor.hpp"
+#include "dashboard_html.h"
+#include "jsonstream.hpp"
+#include "log.hpp"
+
+ESP8266WebServer webServer(80);
+
+// open event streams, an unconnected client marks a free slot
+static WiFiClient sseClients[DASHMAXCLIENTS];
+static unsigned long nextDashPush = 0;
+
+static void handleRoot()
+{
+    webServer.sendHeader("Content-Encoding", "gzip");
+    webServer.sendHeader("Cache-Control", "max-age=86400");
+    webServer.send_P(200, "text/html", (const char *) dashboardHtmlGz, sizeof(dashboardHtmlGz));
+}
+
+// Takes over the connection for a Server-Sent Events stream. The server
+// drops its own reference once we return, our copy keeps the socket open
+// and dashboardLoop() writes to it from then on.
+static void handleEvents()
+{
+    int slot = -1;
+
+    for (int i = 0; i < DASHMAXCLIENTS; i++) {
+        if (!sseClients[i].connected()) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) {
+        webServer.sendHeader("Retry-After", "10");
+        webServer.send(503, "text/plain", "too many dashboard clients");
+        return;
+    }
+
+    WiFiClient client = webServer.client();
+    client.setNoDelay(true);
+    client.print(F("HTTP/1.1 200 OK\r\n"
+                   "Content-Type: text/event-stream\r\n"
+                   "Cache-Control: no-cache\r\n"
+                   "Connection: keep-alive\r\n"
+                   "\r\n"
+                   "retry: 5000\n\n"));
+    sseClients[slot] = client;
+}
+
+static void pushEvent()
+{
+    char dome[12], meat[12], fan[12], target[12];
+    char event[96];
+    int n = snprintf(event, sizeof(event), "data: {\"dome\":%s,\"meat\":%s,\"fan\":%s,\"target\":%s}\n\n",
+                     jsonTemp(dome, sizeof(dome), domeTemp, 1),
+                     jsonTemp(meat, sizeof(meat), meatTemp, 1),
+                     jsonNumber(fan, sizeof(fan), fanOutput * 100.0 / FANWINDOW, 1),
+                     jsonNumber(target, sizeof(target), domeTarget, 0));
+    if (n >= (int) sizeof(event)) {
+        return;
+    }
+
+    for (int i = 0; i < DASHMAXCLIENTS; i++) {
+        WiFiClient &client = sseClients[i];
+        if (!client.connected()) {
+            if (client) {
+                client.stop();
+                sseClients[i] = WiFiClient();
+            }
+            continue;
+        }
+        // never wait on a slow browser, it just misses this sample
+        if (client.availableForWrite() >= n) {
+            client.write((const uint8_t *) event, n);
+        }
+    }
+}
+
+void dashboardBegin()
+{
+    webServer.on("/", HTTP_GET, handleRoot);
+    webServer.on("/events", HTTP_GET, handleEvents);
+    webServer.begin();
+
+    logInfo("dashboard at http://%s", WiFi.localIP().toString().c_str());
+}
+
+void dashboardLoop()
+{
+    webServer.handleClient();
+
+    if (millis() >= nextDashPush) {
+        nextDashPush = millis() + DASHINTERVAL;
+        pushEvent();
+    }
+}
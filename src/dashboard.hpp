@@ -0,0 +1,24 @@
+#ifndef BGE_DASHBOARD_HPP
+#define BGE_DASHBOARD_HPP
+
+#include <ESP8266WebServer.h>
+
+// Local web dashboard: a gzipped single page app served from flash plus a
+// Server-Sent Events stream of the live dome, meat and fan values, so the
+// cook can be watched on the LAN without ThingSpeak or internet access.
+
+// maximum number of browsers attached to /events at once
+#define DASHMAXCLIENTS 2
+// ms between pushed samples
+#define DASHINTERVAL 1000
+
+// web server shared by the dashboard and anything else served on port 80
+extern ESP8266WebServer webServer;
+
+// register the dashboard routes and start listening, call once WiFi is up
+void dashboardBegin();
+
+// service pending HTTP requests and push due events, call from loop()
+void dashboardLoop();
+
+#endif // BGE_DASHBOARD_HPP
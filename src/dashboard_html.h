@@ -0,0 +1,89 @@
+// generated by scripts/webgz.py from web/index.html - do not edit
+#ifndef BGE_DASHBOARD_HTML_H
+#define BGE_DASHBOARD_HTML_H
+
+#include <Arduino.h>
+
+// 1236 bytes, 2400 uncompressed
+static const uint8_t dashboardHtmlGz[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x85, 0x56, 0x5b, 0x6f, 0xdb, 0x36,
+    0x14, 0x7e, 0xf7, 0xaf, 0x50, 0x95, 0x6c, 0x92, 0x5a, 0x49, 0x96, 0x9d, 0xb4, 0xcd, 0x24, 0xd3,
+    0x05, 0xda, 0xa6, 0xc3, 0x06, 0x34, 0x2d, 0xd6, 0xbe, 0x0c, 0x81, 0x1f, 0x68, 0xea, 0xc8, 0x62,
+    0x23, 0x91, 0x02, 0x49, 0xcb, 0xf6, 0x04, 0xff, 0xf7, 0x1d, 0x5a, 0xb2, 0x93, 0x74, 0x69, 0x07,
+    0x03, 0xa6, 0x78, 0xae, 0xdf, 0xb9, 0x4a, 0xb3, 0x67, 0xef, 0x3f, 0xbd, 0xfb, 0xfa, 0xf7, 0xe7,
+    0x6b, 0xa7, 0x34, 0x75, 0x35, 0x1f, 0xcd, 0xec, 0xe1, 0x54, 0x54, 0xac, 0x88, 0x0b, 0xc2, 0xb5,
+    0x04, 0xa0, 0x39, 0x1e, 0x35, 0x18, 0xea, 0xb0, 0x92, 0x2a, 0x0d, 0x86, 0xb8, 0x6b, 0x53, 0x44,
+    0x57, 0xee, 0x91, 0x2c, 0x68, 0x0d, 0xc4, 0x6d, 0x39, 0x6c, 0x1a, 0xa9, 0x8c, 0xeb, 0x30, 0x29,
+    0x0c, 0x08, 0x14, 0xdb, 0xf0, 0xdc, 0x94, 0x24, 0x87, 0x96, 0x33, 0x88, 0x0e, 0x97, 0xd0, 0xe1,
+    0x82, 0x1b, 0x4e, 0xab, 0x48, 0x33, 0x5a, 0x01, 0x99, 0x58, 0x23, 0x86, 0x9b, 0x0a, 0xe6, 0x6f,
+    0x7f, 0xbf, 0x76, 0x3e, 0x4a, 0xe4, 0x4a, 0x35, 0x1b, 0xf7, 0xa4, 0xd1, 0x4c, 0x9b, 0x9d, 0x3d,
+    0x97, 0x32, 0xdf, 0x75, 0x05, 0x9a, 0x8d, 0x0a, 0x5a, 0xf3, 0x6a, 0x97, 0x6a, 0x2a, 0x74, 0xa4,
+    0x41, 0xf1, 0x22, 0xab, 0xa9, 0x5a, 0x71, 0x91, 0x26, 0xd9, 0x92, 0xb2, 0xbb, 0x95, 0x92, 0x6b,
+    0x91, 0xa7, 0x67, 0xd3, 0xe9, 0x34, 0x63, 0xb2, 0x92, 0x2a, 0x3d, 0x03, 0x80, 0xfd, 0xc8, 0x46,
+    0x01, 0xaa, 0x6b, 0x68, 0x9e, 0x73, 0xb1, 0x4a, 0xaf, 0x9a, 0xad, 0x33, 0x99, 0x36, 0xdb, 0x47,
+    0x3a, 0x17, 0x17, 0x17, 0xfb, 0xd1, 0x99, 0x36, 0x5d, 0x51, 0x49, 0x6a, 0x52, 0xc5, 0x57, 0xa5,
+    0xc9, 0x0e, 0x4e, 0x35, 0xff, 0x07, 0xd2, 0xf8, 0x0a, 0xea, 0xa3, 0x4d, 0x4a, 0xe9, 0x7e, 0x14,
+    0xaf, 0xba, 0x9c, 0xeb, 0xa6, 0xa2, 0xbb, 0xb4, 0xa8, 0x60, 0x9b, 0xd9, 0xbf, 0x68, 0xa3, 0x68,
+    0x93, 0xda, 0x3f, 0xe4, 0xb3, 0xce, 0x92, 0xd2, 0x49, 0x56, 0x73, 0xd1, 0x87, 0x9f, 0x4e, 0x2e,
+    0x13, 0xf4, 0x3a, 0x40, 0x46, 0x14, 0xd9, 0x11, 0xd1, 0x53, 0x68, 0xb2, 0xa5, 0x54, 0x88, 0x3a,
+    0x52, 0x34, 0xe7, 0x6b, 0x9d, 0xbe, 0x6a, 0xb6, 0xd6, 0xa8, 0xb3, 0x3c, 0xb9, 0x5d, 0x56, 0x92,
+    0xdd, 0x3d, 0x80, 0x38, 0x8d, 0xa7, 0x50, 0x1f, 0x64, 0x74, 0x43, 0x45, 0xf7, 0x13, 0xec, 0x8c,
+    0x8a, 0x96, 0xea, 0x6e, 0x00, 0x95, 0x24, 0xbf, 0x64, 0x25, 0xd8, 0x78, 0xd3, 0xe9, 0x34, 0xf9,
+    0x0e, 0xc8, 0x94, 0xda, 0xdf, 0x7e, 0x34, 0x1b, 0x0f, 0xc5, 0x98, 0x8d, 0x87, 0x9e, 0xb0, 0x55,
+    0x19, 0x3a, 0x04, 0xd4, 0xc3, 0xfa, 0x39, 0x33, 0xeb, 0xdf, 0xe1, 0x39, 0x71, 0xb5, 0x71, 0xe7,
+    0xd8, 0x0f, 0x02, 0x98, 0xc1, 0x30, 0xd1, 0x06, 0x32, 0xe6, 0xbd, 0x05, 0xd4, 0x19, 0xcd, 0x72,
+    0xde, 0x3a, 0xac, 0xa2, 0x5a, 0x13, 0x77, 0xe5, 0x3e, 0xbe, 0x33, 0x77, 0x7e, 0xb0, 0x33, 0x7f,
+    0x2f, 0x6b, 0x70, 0x7e, 0xcd, 0x61, 0x95, 0x7d, 0x38, 0x1a, 0x58, 0x1e, 0x8c, 0xe7, 0xc8, 0x70,
+    0xe7, 0xd1, 0x6c, 0xbc, 0x1c, 0x24, 0x0d, 0x26, 0x16, 0x8c, 0x33, 0xe3, 0x07, 0x76, 0x7f, 0x3b,
+    0x08, 0xf0, 0xf9, 0xc9, 0x35, 0x7a, 0xf8, 0x81, 0x9f, 0x8f, 0x40, 0xcd, 0x93, 0x7e, 0x6a, 0x64,
+    0x1c, 0xfd, 0xfc, 0x44, 0xff, 0x03, 0xc6, 0xfc, 0xcb, 0x63, 0xcd, 0x82, 0x8a, 0xef, 0x14, 0x87,
+    0xa3, 0x2f, 0xc0, 0x41, 0x86, 0xb5, 0xae, 0xd3, 0x4f, 0x8a, 0xfb, 0x2a, 0x49, 0x5c, 0xa7, 0xaf,
+    0x04, 0x71, 0xb1, 0x14, 0x68, 0x79, 0xdc, 0x4b, 0xda, 0x59, 0x60, 0x8a, 0x37, 0x66, 0x3e, 0x6a,
+    0xa9, 0x72, 0x6e, 0x08, 0x8a, 0x86, 0x25, 0xb9, 0x5d, 0x84, 0xac, 0x25, 0xb9, 0x64, 0xeb, 0x1a,
+    0x27, 0x2e, 0xc6, 0x70, 0xaf, 0x2b, 0xb0, 0x8f, 0x6f, 0x77, 0x7f, 0xe4, 0xbe, 0xc7, 0x5a, 0x2f,
+    0x08, 0xd9, 0x96, 0xb0, 0xd6, 0xb2, 0xde, 0xd9, 0xb9, 0xdc, 0x1a, 0xdf, 0x9b, 0xe6, 0x5e, 0x90,
+    0x8d, 0x8a, 0xb5, 0xc0, 0xa2, 0x48, 0xe1, 0x9c, 0xfb, 0x3c, 0xe8, 0x14, 0x98, 0xb5, 0x12, 0xce,
+    0x8f, 0x4c, 0xf1, 0x60, 0x7f, 0xaf, 0x50, 0x6c, 0xfd, 0x36, 0x14, 0x27, 0x9d, 0x96, 0x10, 0xb1,
+    0xae, 0xaa, 0x37, 0x5e, 0xe4, 0xa5, 0x6d, 0x6c, 0xe4, 0x07, 0xbe, 0x85, 0xdc, 0x17, 0x0f, 0x35,
+    0x9a, 0x4a, 0x1a, 0x3f, 0xe8, 0x46, 0x8e, 0x05, 0xbf, 0xb1, 0x78, 0xfa, 0x75, 0x80, 0x71, 0xe2,
+    0x73, 0x1f, 0x71, 0x58, 0x49, 0x32, 0x81, 0xdf, 0xc2, 0x92, 0x93, 0xc8, 0x9e, 0x3c, 0xbc, 0xcb,
+    0x46, 0x0e, 0xdb, 0xc6, 0xac, 0x02, 0xaa, 0xfe, 0xc2, 0x0e, 0xf2, 0x93, 0x30, 0x09, 0x37, 0xa8,
+    0x84, 0xe8, 0x1d, 0x5e, 0xf8, 0x65, 0x5c, 0x81, 0x58, 0x99, 0x72, 0x36, 0x0d, 0x7a, 0x28, 0x48,
+    0x2e, 0xa4, 0xf2, 0x39, 0x49, 0x32, 0x3e, 0x3b, 0x72, 0x33, 0xfe, 0xe2, 0x45, 0x60, 0xc9, 0x77,
+    0x8e, 0x2c, 0x6e, 0x3d, 0xdb, 0x34, 0x5e, 0xe8, 0xd9, 0x9a, 0xe2, 0xd1, 0xf7, 0x88, 0xb7, 0x08,
+    0xac, 0xb9, 0x5b, 0xbe, 0xb8, 0xbd, 0x5b, 0x3c, 0x3b, 0x44, 0x13, 0x74, 0x08, 0xe7, 0x23, 0x35,
+    0x65, 0x8c, 0xd3, 0xeb, 0x57, 0x32, 0x1c, 0xb8, 0x41, 0x86, 0xf8, 0x7a, 0x3a, 0xdd, 0xfa, 0x25,
+    0x3f, 0xd1, 0xf7, 0x3d, 0x24, 0x1e, 0x55, 0x72, 0x36, 0x49, 0x82, 0xae, 0xe4, 0x2f, 0xc8, 0xcb,
+    0xac, 0x92, 0x11, 0x79, 0x89, 0xac, 0x53, 0x26, 0x2a, 0x2e, 0xc0, 0x2f, 0x42, 0x16, 0xea, 0x50,
+    0x06, 0x1d, 0x46, 0xa7, 0x8d, 0x92, 0x77, 0xf0, 0xc5, 0xce, 0x16, 0x61, 0x19, 0x12, 0x96, 0x80,
+    0xcb, 0xe1, 0x33, 0x7a, 0xf0, 0x83, 0xec, 0x07, 0xd1, 0x74, 0x47, 0xb4, 0xc5, 0xa2, 0xcf, 0x7d,
+    0x60, 0x77, 0x2e, 0x17, 0x6b, 0xc8, 0x6c, 0x82, 0xb7, 0x84, 0x3f, 0xdf, 0x8c, 0xfd, 0x9b, 0x68,
+    0x12, 0x84, 0x3b, 0x52, 0x9a, 0xe8, 0x28, 0x1c, 0xc9, 0xe0, 0x79, 0x69, 0xc6, 0x3a, 0xe3, 0x6f,
+    0xd0, 0x91, 0x85, 0xf2, 0x55, 0xfa, 0xdb, 0x70, 0x17, 0xa4, 0x78, 0xad, 0x65, 0x7b, 0xbc, 0xee,
+    0x4f, 0xb8, 0x7c, 0x1b, 0xd7, 0x01, 0xb3, 0x87, 0xbd, 0x8c, 0x09, 0x3b, 0xbb, 0x7c, 0x75, 0xe5,
+    0x85, 0xb8, 0x32, 0xc2, 0x24, 0xc8, 0x7a, 0xc6, 0x90, 0x43, 0xe4, 0xbd, 0x7e, 0xfd, 0xda, 0x0b,
+    0x0f, 0x29, 0xc0, 0x62, 0x1e, 0xd9, 0x43, 0xa6, 0xcf, 0xd8, 0xd5, 0xe5, 0x7f, 0x99, 0x43, 0x35,
+    0xce, 0xe0, 0xf2, 0x11, 0x73, 0xf4, 0xa0, 0x77, 0x86, 0xf5, 0x71, 0x6a, 0x1f, 0xd0, 0x44, 0xc0,
+    0xc6, 0xb9, 0x6e, 0xb1, 0x37, 0xbf, 0xc8, 0xb5, 0x62, 0x68, 0x66, 0x0c, 0xf6, 0xa6, 0x6d, 0x5b,
+    0x23, 0x3f, 0x96, 0x42, 0x36, 0x20, 0xc8, 0xd1, 0x04, 0xaa, 0x9e, 0xfb, 0x9e, 0x36, 0x5e, 0x10,
+    0xdb, 0x01, 0x78, 0x37, 0xbc, 0x9f, 0xbc, 0x8a, 0xb7, 0xe0, 0xed, 0x8f, 0x2a, 0xa0, 0x94, 0x54,
+    0xff, 0xab, 0xa3, 0xe0, 0x7e, 0x9d, 0x79, 0x19, 0x2a, 0xb2, 0x4a, 0x6a, 0x4c, 0x53, 0x86, 0x2f,
+    0xc6, 0xaf, 0xbc, 0x06, 0xb9, 0x36, 0xfe, 0x20, 0x11, 0xbe, 0x4c, 0x92, 0x24, 0x38, 0xd9, 0xaf,
+    0x41, 0x6b, 0xba, 0x82, 0x7b, 0x0f, 0x60, 0x23, 0x3a, 0x84, 0x94, 0x93, 0x3f, 0xbf, 0x7c, 0xba,
+    0x89, 0x1b, 0xfb, 0x7a, 0xf5, 0x21, 0xce, 0xa9, 0xa1, 0x36, 0x12, 0x9c, 0xcc, 0x3e, 0x41, 0x8f,
+    0x31, 0xe0, 0xf8, 0xe5, 0xb1, 0xa5, 0x87, 0x93, 0x20, 0x3b, 0x1f, 0x12, 0xfc, 0x84, 0x88, 0xa5,
+    0x5b, 0x91, 0xde, 0x90, 0x2d, 0xdf, 0x13, 0x42, 0x48, 0xb6, 0x95, 0x3c, 0x3f, 0x95, 0xf1, 0x09,
+    0x99, 0x9e, 0x63, 0xc5, 0xd0, 0x54, 0x19, 0x37, 0x6b, 0x5d, 0xfa, 0x79, 0x90, 0x3d, 0x98, 0xc0,
+    0xf9, 0x4d, 0x50, 0xc6, 0xba, 0xe4, 0x05, 0x96, 0x29, 0xeb, 0x87, 0x1d, 0x65, 0xf7, 0x87, 0x3a,
+    0x82, 0x61, 0x25, 0x56, 0x88, 0x36, 0x7c, 0x5c, 0x72, 0x8d, 0xaf, 0x87, 0xdd, 0x1b, 0xc3, 0x41,
+    0x91, 0xc4, 0xba, 0x2a, 0x41, 0xf8, 0xa7, 0x84, 0xa8, 0xd3, 0x4a, 0x51, 0xf1, 0x37, 0x6d, 0x6b,
+    0xb0, 0xff, 0x5e, 0xe4, 0x9b, 0xcd, 0xd9, 0xb7, 0xb8, 0x91, 0x1c, 0xcb, 0x1d, 0xe3, 0x78, 0x5c,
+    0x53, 0xb4, 0x7e, 0x62, 0x37, 0x38, 0x77, 0x3d, 0xbe, 0xce, 0x26, 0x28, 0x6d, 0x6e, 0x27, 0x8b,
+    0xd0, 0xe6, 0x01, 0x9f, 0xa6, 0x8b, 0x10, 0x83, 0xc5, 0x87, 0x8b, 0x45, 0xd8, 0x47, 0x94, 0xda,
+    0xd1, 0xd9, 0xa3, 0x13, 0xc4, 0x5a, 0x12, 0x0c, 0xa0, 0xc2, 0x0f, 0x15, 0x3f, 0xba, 0xb9, 0x0f,
+    0x01, 0xfd, 0x33, 0x6a, 0x1e, 0x7a, 0x08, 0xba, 0x23, 0xa6, 0xa1, 0xca, 0x28, 0x85, 0x3b, 0x7f,
+    0xd8, 0xcd, 0xb8, 0xe9, 0xfb, 0x97, 0xe2, 0xb8, 0xff, 0x9e, 0xfa, 0x17, 0xfd, 0xd7, 0xb5, 0xca,
+    0x60, 0x09, 0x00, 0x00,
+};
+
+#endif // BGE_DASHBOARD_HTML_H
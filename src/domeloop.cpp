@@ -0,0 +1,79 @@
+#include "domeloop.hpp"
+
+#include "bgemonitor.hpp"
+#include "model.hpp"
+#include "mpc.hpp"
+#include "probe.hpp"
+
+static DomeLoop running = LOOP_PID;
+
+// Moves fanOutput toward wanted no faster than domePID's output rate. The
+// limit holds for the fan as a whole, so a feed-forward step or an MPC move
+// is slewed the same as a PID move.
+static void slewFan(double wanted, double dt)
+{
+    double rate = domePID.GetOutputRate();
+    if (rate > 0) {
+        wanted = constrain(wanted, fanOutput - rate * dt, fanOutput + rate * dt);
+    }
+    fanOutput = constrain(wanted, 0.0, (double) FANWINDOW);
+}
+
+DomeLoop domeControl(bool fresh, bool blind, double dt)
+{
+    DomeLoop want = blind                 ? LOOP_SAFE
+                    : mpcActive()         ? LOOP_MPC
+                    : feedForwardActive() ? LOOP_FEEDFORWARD
+                                          : LOOP_PID;
+    if (want != running) {
+        running = want;
+        if (want == LOOP_MPC) {
+            mpcOutput = fanOutput;
+            domeMpc.start();
+        } else if (want != LOOP_SAFE && domePID.GetMode() == AUTOMATIC) {
+            domePID.SetMode(MANUAL);
+            domeAutomatic();
+        }
+    }
+
+    if (running == LOOP_SAFE) {
+        // blind, so the fan holds a duty the user chose, at once; a manual
+        // fan stays
+        if (domePID.GetMode() == AUTOMATIC) {
+            fanOutput = probeSafeOutput();
+        }
+    } else if (running == LOOP_MPC) {
+        domeMpc.Compute();
+        slewFan(mpcOutput, dt);
+    } else {
+        // the PID works around the feed-forward: it holds the model's
+        // temperature, and its limits move with the feed-forward so the
+        // sum stays inside the window without winding up the integrator
+        double feedForward = feedForwardOutput();
+        domeReference      = feedForwardReference();
+        domePID.SetOutputLimits(-feedForward, FANWINDOW - feedForward);
+        if (fresh) {
+            domePID.Compute();
+        }
+        if (domePID.GetMode() == AUTOMATIC) {
+            slewFan(pidOutput + feedForward, dt);
+            // the PID's share is what the fan really got, so its own rate
+            // window and anti-windup see the limit too
+            pidOutput = fanOutput - feedForward;
+        }
+    }
+    modelSample(fanOutput / FANWINDOW, domeTempF);
+    return running;
+}
+
+void domeAutomatic()
+{
+    if (domePID.GetMode() == AUTOMATIC) {
+        return;
+    }
+    double feedForward = feedForwardOutput();
+    domeReference      = feedForwardReference();
+    domePID.SetOutputLimits(-feedForward, FANWINDOW - feedForward);
+    pidOutput = fanOutput - feedForward;
+    domePID.SetMode(AUTOMATIC);
+}
@@ -0,0 +1,23 @@
+#ifndef BGE_DOMELOOP_HPP
+#define BGE_DOMELOOP_HPP
+
+#include <Arduino.h>
+
+// The dome's controllers and the one in charge of the fan. domePID works
+// around the feed-forward while the model is trusted (model.hpp), the MPC
+// takes over when enabled (mpc.hpp), and a faulted probe leaves the fan
+// at a safe duty (probe.hpp). A change of controller is not a setpoint
+// change: the new one starts from the fan as it is.
+//
+// controlTick reads the thermocouple and switches the fan relay; all it
+// does in between is call domeControl() once a pass. The host tests run
+// the same function against a simulated grill.
+
+enum DomeLoop { LOOP_PID, LOOP_FEEDFORWARD, LOOP_MPC, LOOP_SAFE };
+
+// One control pass, dt seconds after the last. fresh when domeTempF is a
+// new reading, blind while the dome probe is faulted. Sets fanOutput,
+// feeds the model, and returns the controller now in charge.
+DomeLoop domeControl(bool fresh, bool blind, double dt);
+
+#endif // BGE_DOMELOOP_HPP
@@ -0,0 +1,134 @@
+#include "domepid.hpp"
+
+DomePid::DomePid(double *in, double *out, double *sp, double p, double i, double d, int dir)
+    : input(in), output(out), setpoint(sp), outMin(0), outMax(255), rate(0), filter(0), integral(0),
+      derivative(0), lastInput(0), sampleTime(100), direction(dir), inAuto(false)
+{
+    SetTunings(p, i, d);
+    lastTime = millis() - sampleTime;
+}
+
+bool DomePid::Compute()
+{
+    if (!inAuto) {
+        return false;
+    }
+    unsigned long now = millis();
+    if (now - lastTime < sampleTime || now == lastTime) {
+        return false;
+    }
+    double dt = (now - lastTime) / 1000.0;
+    lastTime  = now;
+
+    double error  = *setpoint - *input;
+    double dInput = *input - lastInput;
+    lastInput     = *input;
+
+    // a low-pass ahead of the derivative, alpha = Tf / (Tf + dt)
+    double alpha = filter / (filter + dt);
+    derivative   = alpha * derivative - (1 - alpha) * kd * dInput / dt;
+
+    double p = kp * error;
+    double d = derivative;
+
+    // how far the output can go this pass
+    double lo = outMin, hi = outMax;
+    if (rate > 0) {
+        lo = max(lo, *output - rate * dt);
+        hi = min(hi, *output + rate * dt);
+    }
+
+    // no integrating into a limit the output is already held at
+    double wanted = p + integral + d;
+    bool   pinned = (wanted >= hi && ki * error > 0) || (wanted <= lo && ki * error < 0);
+    if (!pinned) {
+        integral += ki * error * dt;
+    }
+
+    double raw = p + integral + d;
+    double out = constrain(raw, lo, hi);
+
+    // back-calculation: bleed off what the fan could not deliver
+    integral += min(tracking * dt, 1.0) * (out - raw);
+    integral  = constrain(integral, outMin, outMax);
+
+    *output = out;
+    return true;
+}
+
+void DomePid::SetMode(int mode)
+{
+    bool automatic = mode == AUTOMATIC;
+    if (automatic && !inAuto) {
+        initialize();
+    }
+    inAuto = automatic;
+}
+
+// bumpless: the integral picks up the output as it is
+void DomePid::initialize()
+{
+    integral   = constrain(*output, outMin, outMax);
+    derivative = 0;
+    lastInput  = *input;
+    lastTime   = millis();
+}
+
+void DomePid::SetOutputLimits(double min, double max)
+{
+    if (min >= max) {
+        return;
+    }
+    outMin = min;
+    outMax = max;
+    if (inAuto) {
+        *output  = constrain(*output, outMin, outMax);
+        integral = constrain(integral, outMin, outMax);
+    }
+}
+
+void DomePid::SetTunings(double p, double i, double d)
+{
+    if (p < 0 || i < 0 || d < 0) {
+        return;
+    }
+    dispKp = p;
+    dispKi = i;
+    dispKd = d;
+
+    double sign = direction == REVERSE ? -1 : 1;
+    kp          = sign * p;
+    ki          = sign * i;
+    kd          = sign * d;
+
+    // Tt = sqrt(Ti Td) with Ti = Kp / Ki and Td = Kd / Kp
+    if (p > 0 && i > 0) {
+        double ti = p / i;
+        tracking  = d > 0 ? 1 / sqrt(ti * d / p) : 1 / ti;
+    } else {
+        tracking = i > 0 ? 1 : 0;
+    }
+}
+
+void DomePid::SetControllerDirection(int dir)
+{
+    direction = dir;
+    SetTunings(dispKp, dispKi, dispKd);
+}
+
+void DomePid::SetSampleTime(int ms)
+{
+    if (ms >= 0) {
+        sampleTime = ms;
+    }
+}
+
+void DomePid::SetDerivativeFilter(double seconds)
+{
+    filter = seconds > 0 ? seconds : 0;
+}
+
+void DomePid::SetOutputRate(double perSecond)
+{
+    rate = perSecond > 0 ? perSecond : 0;
+}
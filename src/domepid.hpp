@@ -0,0 +1,87 @@
+#ifndef BGE_DOMEPID_HPP
+#define BGE_DOMEPID_HPP
+
+#include <Arduino.h>
+#include <PID_v1.h> // AUTOMATIC, MANUAL, DIRECT, REVERSE
+
+// PID for the dome fan, a drop-in for PID_v1 that handles saturation.
+//
+// On a heat-up the fan sits at full for many minutes. PID_v1 keeps adding
+// to its output sum all that time, only clipping it at the output limit,
+// and the sum then has to unwind through a long overshoot. Here
+//
+//   - the integral is frozen while the output is pinned at a limit and
+//     the error pushes it further (conditional integration),
+//   - whatever the actuator could not deliver is fed back into the
+//     integral with time constant Tt = sqrt(Ti Td), or Ti without a
+//     derivative (back-calculation), and
+//   - the output may move at most a set rate, which also counts as
+//     saturation for both of the above. controlTick holds the whole fan
+//     output, feed-forward or MPC included, to the same rate and hands
+//     the PID back its share of what was delivered.
+//
+// The derivative acts on the measurement through a first-order low-pass,
+// so a thermocouple stepping by its 0.45 F resolution does not kick the
+// fan. Time between passes is measured, not assumed; with a sample time
+// of 0 every Compute() is a pass, and the caller calls it once per fresh
+// reading.
+//
+// None of this helps with an integral that fills before the fan saturates.
+// With the stock gains, aggKp/aggKi/aggKd in bgemonitor.cpp, the integral
+// time is 20 s against a dome that takes ten minutes. The integral is full
+// two minutes into a heat-up and DomePid overshoots as far as PID_v1 did.
+// Anti-windup and the rate limit pay off only once the gains lean on the
+// proportional term, e.g. 20/0.05/0 at 1 %/s through PUT /api/tunings. The
+// simulated figures are in test/test_antiwindup.
+//
+// Gains are per second, as PID_v1's SetTunings() takes them.
+
+class DomePid
+{
+  public:
+    DomePid(double *in, double *out, double *sp, double p, double i, double d, int dir);
+
+    // true when a new output was written
+    bool Compute();
+
+    void SetMode(int mode);
+    void SetOutputLimits(double min, double max);
+    void SetTunings(double kp, double ki, double kd);
+    void SetControllerDirection(int direction);
+    // minimum ms between passes, 0 to compute on every call
+    void SetSampleTime(int ms);
+
+    // time constant of the derivative low-pass in seconds, 0 for none
+    void   SetDerivativeFilter(double seconds);
+    double GetDerivativeFilter() const { return filter; }
+
+    // largest output change per second, 0 for no limit
+    void   SetOutputRate(double perSecond);
+    double GetOutputRate() const { return rate; }
+
+    double GetKp() const { return dispKp; }
+    double GetKi() const { return dispKi; }
+    double GetKd() const { return dispKd; }
+    int    GetMode() const { return inAuto ? AUTOMATIC : MANUAL; }
+    int    GetDirection() const { return direction; }
+
+  private:
+    void initialize();
+
+    double       *input, *output, *setpoint;
+    double        dispKp, dispKi, dispKd;
+    double        kp, ki, kd; // signed for the direction
+    double        tracking;   // 1 / Tt
+    double        outMin, outMax;
+    double        rate;
+    double        filter;
+    double        integral;
+    double        derivative; // filtered derivative term
+    double        lastInput;
+    unsigned long lastTime;
+    unsigned long sampleTime;
+    int           direction;
+    bool          inAuto;
+};
+
+#endif // BGE_DOMEPID_HPP
@@ -0,0 +1,131 @@
+#include "fastwifi.hpp"
+
+#include <ESP8266WiFi.h>
+#include <LittleFS.h>
+
+#include "crc32.hpp"
+#include "log.hpp"
+#include "rtcmem.hpp"
+
+#define FASTWIFI_FILE "/wifi.bin"
+
+struct WifiCache {
+    uint32_t magic;
+    uint8_t  bssid[6];
+    uint8_t  channel;
+    uint8_t  reserved;
+    uint32_t ip, gateway, subnet, dns;
+    uint32_t crc;
+};
+
+static_assert(sizeof(WifiCache) % 4 == 0, "RTC memory is written in 4 byte blocks");
+
+unsigned long wifiConnectMs = 0;
+bool          wifiConnectFast = false;
+
+static bool validCache(const WifiCache &cache)
+{
+    return cache.magic == RTC_WIFICACHE_MAGIC && cache.channel > 0 &&
+           cache.crc == crc32Of(&cache, offsetof(WifiCache, crc));
+}
+
+// RTC first, it is free to read and survives everything but power loss
+static bool loadCache(WifiCache &cache)
+{
+    if (ESP.rtcUserMemoryRead(RTC_WIFICACHE_BLOCK, (uint32_t *) &cache, sizeof(cache)) && validCache(cache)) {
+        return true;
+    }
+    if (!LittleFS.begin()) {
+        return false;
+    }
+    File f = LittleFS.open(FASTWIFI_FILE, "r");
+    if (!f) {
+        return false;
+    }
+    bool ok = f.read((uint8_t *) &cache, sizeof(cache)) == sizeof(cache) && validCache(cache);
+    f.close();
+    return ok;
+}
+
+bool wifiFastConnect()
+{
+    unsigned long start = millis();
+    WifiCache     cache;
+
+    if (!loadCache(cache)) {
+        return false;
+    }
+    // the SDK keeps the credentials WiFiManager stored
+    String ssid = WiFi.SSID();
+    String pass = WiFi.psk();
+    if (ssid.length() == 0) {
+        return false;
+    }
+
+    // a BSSID/channel specific config must not overwrite the saved one
+    WiFi.persistent(false);
+    WiFi.mode(WIFI_STA);
+    WiFi.config(IPAddress(cache.ip), IPAddress(cache.gateway), IPAddress(cache.subnet), IPAddress(cache.dns));
+    WiFi.begin(ssid.c_str(), pass.c_str(), cache.channel, cache.bssid);
+    WiFi.persistent(true);
+
+    while (WiFi.status() != WL_CONNECTED && millis() - start < FASTWIFI_TIMEOUT) {
+        delay(10);
+    }
+
+    wifiConnectMs = millis() - start;
+    if (WiFi.status() != WL_CONNECTED) {
+        logWarn("fast connect failed after %lums", wifiConnectMs);
+        wifiFastAbandon();
+        return false;
+    }
+    wifiConnectFast = true;
+    logInfo("fast connect in %lums", wifiConnectMs);
+    return true;
+}
+
+void wifiFastAbandon()
+{
+    WiFi.disconnect();
+    WiFi.config(IPAddress(0, 0, 0, 0), IPAddress(0, 0, 0, 0), IPAddress(0, 0, 0, 0));
+}
+
+void wifiCacheSave()
+{
+    WifiCache cache;
+    WifiCache saved;
+
+    if (WiFi.status() != WL_CONNECTED) {
+        return;
+    }
+    memset(&cache, 0, sizeof(cache));
+    cache.magic = RTC_WIFICACHE_MAGIC;
+    memcpy(cache.bssid, WiFi.BSSID(), sizeof(cache.bssid));
+    cache.channel = WiFi.channel();
+    cache.ip      = WiFi.localIP();
+    cache.gateway = WiFi.gatewayIP();
+    cache.subnet  = WiFi.subnetMask();
+    cache.dns     = WiFi.dnsIP();
+    cache.crc     = crc32Of(&cache, offsetof(WifiCache, crc));
+
+    ESP.rtcUserMemoryWrite(RTC_WIFICACHE_BLOCK, (uint32_t *) &cache, sizeof(cache));
+
+    // flash is worn only when the AP or lease actually changed
+    if (!LittleFS.begin()) {
+        return;
+    }
+    File f = LittleFS.open(FASTWIFI_FILE, "r");
+    if (f) {
+        bool same = f.read((uint8_t *) &saved, sizeof(saved)) == sizeof(saved) &&
+                    memcmp(&saved, &cache, sizeof(cache)) == 0;
+        f.close();
+        if (same) {
+            return;
+        }
+    }
+    f = LittleFS.open(FASTWIFI_FILE, "w");
+    if (f) {
+        f.write((const uint8_t *) &cache, sizeof(cache));
+        f.close();
+    }
+}
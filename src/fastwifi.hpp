@@ -0,0 +1,28 @@
+#ifndef BGE_FASTWIFI_HPP
+#define BGE_FASTWIFI_HPP
+
+#include <Arduino.h>
+
+// Fast reconnect after a reset. The BSSID, channel and DHCP lease of the
+// last good connection are kept in RTC memory and in flash, and the next
+// boot joins that AP directly with a static IP instead of scanning and
+// waiting on DHCP. Only when that fails does the full WiFiManager flow run.
+
+// ms to wait for the cached AP before giving up on the fast path
+#define FASTWIFI_TIMEOUT 3000
+
+// try the cached AP, true once connected
+bool wifiFastConnect();
+
+// drop the static IP the fast path may have set, before a full connect
+void wifiFastAbandon();
+
+// remember the current connection, call once connected. Flash is only
+// rewritten when something changed.
+void wifiCacheSave();
+
+// how long the last connect took and whether the fast path made it
+extern unsigned long wifiConnectMs;
+extern bool          wifiConnectFast;
+
+#endif // BGE_FASTWIFI_HPP
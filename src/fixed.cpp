@@ -0,0 +1,46 @@
+#include "fixed.hpp"
+
+static const uint16_t powers[] = { 1, 10, 100, 1000 };
+
+size_t fmtDecimal(char *buf, size_t len, int32_t v, uint8_t decimals)
+{
+    char     digits[12]; // least significant first
+    uint8_t  n = 0;
+    uint32_t m = v < 0 ? -(uint32_t) v : (uint32_t) v;
+    size_t   out = 0;
+
+    do {
+        digits[n++] = '0' + m % 10;
+        m /= 10;
+    } while (m > 0 || n <= decimals);
+
+    if (v < 0) {
+        if (out + 1 < len) {
+            buf[out] = '-';
+        }
+        out++;
+    }
+    while (n > 0) {
+        if (out + 1 < len) {
+            buf[out] = digits[n - 1];
+        }
+        out++;
+        if (--n == decimals && n > 0) {
+            if (out + 1 < len) {
+                buf[out] = '.';
+            }
+            out++;
+        }
+    }
+    if (len > 0) {
+        buf[min(out, len - 1)] = '\0';
+    }
+    return out;
+}
+
+size_t fmtFixed(char *buf, size_t len, int32_t v, uint8_t fracBits, uint8_t decimals)
+{
+    decimals = min(decimals, (uint8_t) 3);
+    int32_t scaled = roundShift(v * (int32_t) powers[decimals], fracBits);
+    return fmtDecimal(buf, len, scaled, decimals);
+}
@@ -0,0 +1,45 @@
+#ifndef BGE_FIXED_HPP
+#define BGE_FIXED_HPP
+
+#include <Arduino.h>
+
+// Fixed-point temperatures. A reading goes from the thermocouple through
+// the probe checks and into telemetry as an int16_t in 1/TEMP_SCALE F, and
+// becomes text only at the edge, through fmtFixed(), which does no
+// floating point. The controllers keep their double inputs, converted once
+// per reading with tempToF().
+
+#define TEMP_SCALE 16        // fixed-point temperatures are in 1/16 F
+#define TEMP_SHIFT 4         // log2 of TEMP_SCALE
+#define TEMP_NONE  INT16_MIN // no reading
+
+// fan duty in telemetry, 0.01 %
+#define FAN_SCALE 100
+
+inline double tempToF(int16_t t)
+{
+    return t == TEMP_NONE ? NAN : t * (1.0 / TEMP_SCALE);
+}
+
+// for setpoints and anything else that starts out as a double
+inline int16_t tempFromF(double f)
+{
+    return isnan(f) ? TEMP_NONE : constrain(lround(f * TEMP_SCALE), INT16_MIN + 1L, (long) INT16_MAX);
+}
+
+// v / 2^shift, rounded half away from zero
+inline int32_t roundShift(int32_t v, uint8_t shift)
+{
+    int32_t half = shift > 0 ? 1L << (shift - 1) : 0;
+    return v >= 0 ? (v + half) >> shift : -((-v + half) >> shift);
+}
+
+// Writes v / 10^decimals, e.g. 4503 with 1 decimal as "450.3", and
+// returns the length like snprintf. Integer only.
+size_t fmtDecimal(char *buf, size_t len, int32_t v, uint8_t decimals);
+
+// The same for v / 2^fracBits, rounded half away from zero to decimals
+// places, at most 3; v times 10^decimals must fit in 32 bits.
+size_t fmtFixed(char *buf, size_t len, int32_t v, uint8_t fracBits, uint8_t decimals);
+
+#endif // BGE_FIXED_HPP
@@ -0,0 +1,116 @@
+#include "health.hpp"
+
+#include "bgemonitor.hpp"
+#include "log.hpp"
+
+HealthStats health;
+
+static unsigned long nextSample = 0;
+static unsigned long nextTrend  = 0;
+static uint16_t      trend[HEALTH_TREND];
+static uint8_t       trendCount = 0;
+static uint8_t       trendNext  = 0;
+
+static const char *const alertNames[] = { "ok", "falling", "low" };
+static const char *const resetNames[] = { "power", "watchdog", "exception", "soft watchdog", "restart", "deep sleep", "external" };
+
+// least squares slope of the trend points, in bytes per minute
+static float trendSlope()
+{
+    float sx = 0, sy = 0, sxx = 0, sxy = 0;
+    float n  = trendCount;
+
+    for (uint8_t i = 0; i < trendCount; i++) {
+        // oldest first
+        float y = trend[(trendNext + HEALTH_TREND - trendCount + i) % HEALTH_TREND];
+        sx  += i;
+        sy  += y;
+        sxx += (float) i * i;
+        sxy += i * y;
+    }
+    return (n * sxy - sx * sy) / (n * sxx - sx * sx);
+}
+
+static uint8_t assess()
+{
+    // a little hysteresis so a block hovering at the limit alerts once
+    uint16_t clearAt = HEALTH_MINBLOCK + HEALTH_MINBLOCK / 4;
+
+    if (health.maxBlock < HEALTH_MINBLOCK || (health.alert == HEALTH_LOW && health.maxBlock < clearAt)) {
+        return HEALTH_LOW;
+    }
+    if (trendCount < HEALTH_TREND / 4 || health.blockTrend >= 0) {
+        return HEALTH_OK;
+    }
+    float minutesLeft = (health.maxBlock - HEALTH_MINBLOCK) * 60.0f / -health.blockTrend;
+    float horizon     = health.alert == HEALTH_FALLING ? 2 * HEALTH_HORIZON : HEALTH_HORIZON;
+    return minutesLeft < horizon ? HEALTH_FALLING : HEALTH_OK;
+}
+
+static void sample()
+{
+    health.heapFree      = ESP.getFreeHeap();
+    health.maxBlock      = ESP.getMaxFreeBlockSize();
+    health.fragmentation = ESP.getHeapFragmentation();
+    health.stackFree     = ESP.getFreeContStack();
+    health.heapFreeMin   = min(health.heapFreeMin, health.heapFree);
+    health.maxBlockMin   = min(health.maxBlockMin, health.maxBlock);
+
+    if ((long) (millis() - nextTrend) >= 0) {
+        nextTrend        = millis() + 60000;
+        trend[trendNext] = health.maxBlock;
+        trendNext        = (trendNext + 1) % HEALTH_TREND;
+        trendCount       = min(trendCount + 1, HEALTH_TREND);
+        if (trendCount >= HEALTH_TREND / 4) {
+            health.blockTrend = trendSlope() * 60;
+        }
+    }
+
+    uint8_t alert = assess();
+    if (alert != health.alert) {
+        if (alert > health.alert) {
+            char message[80];
+            snprintf(message, sizeof(message), "BGE memory %s: largest block %u, trend %d/h",
+                     alertNames[alert], health.maxBlock, health.blockTrend);
+            logWarn("%s", message);
+            sendAlert(message);
+        } else {
+            logInfo("memory alert cleared, largest block %u", health.maxBlock);
+        }
+        health.alert = alert;
+    }
+}
+
+void healthBegin()
+{
+    const rst_info *info = ESP.getResetInfoPtr();
+
+    health.heapFreeMin = UINT32_MAX;
+    health.maxBlockMin = UINT16_MAX;
+    health.resetReason = info->reason;
+    if (info->reason == REASON_EXCEPTION_RST) {
+        health.excCause   = info->exccause;
+        health.excAddress = info->epc1;
+    }
+    logInfo("reset by %s", healthResetName(health.resetReason));
+    sample();
+}
+
+void healthLoop()
+{
+    if ((long) (millis() - nextSample) < 0) {
+        return;
+    }
+    nextSample = millis() + HEALTH_INTERVAL;
+    sample();
+}
+
+const char *healthAlertName(uint8_t alert)
+{
+    return alert <= HEALTH_LOW ? alertNames[alert] : "?";
+}
+
+const char *healthResetName(uint8_t reason)
+{
+    return reason < sizeof(resetNames) / sizeof(resetNames[0]) ? resetNames[reason] : "unknown";
+}
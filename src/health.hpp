@@ -0,0 +1,46 @@
+#ifndef BGE_HEALTH_HPP
+#define BGE_HEALTH_HPP
+
+#include <Arduino.h>
+
+// Memory health. Samples the heap and the loop stack every few seconds so
+// a leak or creeping fragmentation shows up in telemetry, and raises an
+// alert while there is still time to act, before an allocation fails in
+// the middle of a cook and the watchdog takes the controller down.
+//
+// The alert fires when the largest free block is below HEALTH_MINBLOCK, or
+// when its trend over the last half hour says it will be within
+// HEALTH_HORIZON minutes.
+
+#define HEALTH_INTERVAL 5000 // ms between samples
+#define HEALTH_MINBLOCK 4096 // bytes, smallest largest-free-block we are happy with
+#define HEALTH_TREND    32   // one-minute points in the trend
+#define HEALTH_HORIZON  60   // minutes of warning the trend alert aims for
+
+enum HealthAlert { HEALTH_OK, HEALTH_FALLING, HEALTH_LOW };
+
+struct HealthStats {
+    uint32_t heapFree;
+    uint32_t heapFreeMin;   // lowest seen since boot
+    uint16_t maxBlock;      // largest allocation that would succeed now
+    uint16_t maxBlockMin;
+    uint8_t  fragmentation; // percent
+    uint32_t stackFree;     // least free cont stack there has ever been
+    int32_t  blockTrend;    // bytes per hour, 0 until the trend has enough points
+    uint8_t  alert;         // HealthAlert
+    uint8_t  resetReason;   // rst_reason of this boot
+    uint32_t excCause;      // for an exception reset
+    uint32_t excAddress;
+};
+
+extern HealthStats health;
+
+void healthBegin();
+
+// call from loop()
+void healthLoop();
+
+const char *healthAlertName(uint8_t alert);
+const char *healthResetName(uint8_t reason);
+
+#endif // BGE_HEALTH_HPP
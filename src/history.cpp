@@ -0,0 +1,162 @@
+#include "history.hpp"
+
+// aggregation interval of each tier in seconds
+static const uint16_t tierPeriod[HISTORY_TIERS] = { 1, 15, 300 };
+
+// dome min/max distance from the mean for each 4 bit code, in 1/2 F.
+// Roughly logarithmic so small swings keep their resolution.
+static const uint8_t spreadSteps[16] = { 0, 2, 4, 6, 8, 10, 12, 16, 20, 24, 32, 40, 48, 64, 96, 128 };
+
+// 1/16 F to 1/HISTORY_TEMP_SCALE F
+static int16_t quantize(int16_t t)
+{
+    return roundShift((int32_t) t * HISTORY_TEMP_SCALE, TEMP_SHIFT);
+}
+
+History::History() : lastSecond(0), started(false)
+{
+    resetAccumulator(acc1);
+    resetAccumulator(acc2);
+}
+
+uint16_t History::period(uint8_t tier) const
+{
+    return tier < HISTORY_TIERS ? tierPeriod[tier] : 0;
+}
+
+uint16_t History::size(uint8_t tier) const
+{
+    switch (tier) {
+    case 0: return tier0.size();
+    case 1: return tier1.size();
+    case 2: return tier2.size();
+    default: return 0;
+    }
+}
+
+void History::add(uint32_t now, int16_t dome, int16_t meat, uint16_t fan)
+{
+    int16_t value[HISTORY_CHANNELS];
+    uint8_t valid = 1 << HISTORY_FAN;
+
+    if (dome != TEMP_NONE) {
+        value[HISTORY_DOME] = quantize(dome);
+        valid |= 1 << HISTORY_DOME;
+    }
+    if (meat != TEMP_NONE) {
+        value[HISTORY_MEAT] = quantize(meat);
+        valid |= 1 << HISTORY_MEAT;
+    }
+    value[HISTORY_FAN] = (fan + FAN_SCALE / 2) / FAN_SCALE;
+
+    if (started) {
+        if (now <= lastSecond) {
+            return;
+        }
+        // fill a stall with gaps, clipped to an hour so a long one can't
+        // hold up the loop
+        uint32_t gap = now - lastSecond - 1;
+        if (gap > 3600) {
+            gap = 3600;
+        }
+        for (uint32_t s = now - gap; s < now; s++) {
+            addSlot(s, value, 0);
+        }
+    }
+    started = true;
+    addSlot(now, value, valid);
+}
+
+void History::addSlot(uint32_t second, const int16_t *value, uint8_t valid)
+{
+    int16_t mean[HISTORY_CHANNELS];
+
+    lastSecond = second;
+    tier0.push(value, valid, 0);
+
+    accumulate(acc1, value, valid);
+    if (acc1.slots == tierPeriod[1]) {
+        uint8_t ok = collapse(acc1, mean);
+        tier1.push(mean, ok, spreadCode(mean[HISTORY_DOME], acc1.domeMin, acc1.domeMax));
+        resetAccumulator(acc1);
+    }
+
+    accumulate(acc2, value, valid);
+    if (acc2.slots == tierPeriod[2]) {
+        uint8_t ok = collapse(acc2, mean);
+        tier2.push(mean, ok, spreadCode(mean[HISTORY_DOME], acc2.domeMin, acc2.domeMax));
+        resetAccumulator(acc2);
+    }
+}
+
+void History::resetAccumulator(Accumulator &acc)
+{
+    memset(&acc, 0, sizeof(acc));
+    acc.domeMin = INT16_MAX;
+    acc.domeMax = INT16_MIN;
+}
+
+void History::accumulate(Accumulator &acc, const int16_t *value, uint8_t valid)
+{
+    acc.slots++;
+    for (uint8_t c = 0; c < HISTORY_CHANNELS; c++) {
+        if (valid & (1 << c)) {
+            acc.sum[c] += value[c];
+            acc.n[c]++;
+        }
+    }
+    if (valid & (1 << HISTORY_DOME)) {
+        acc.domeMin = min(acc.domeMin, value[HISTORY_DOME]);
+        acc.domeMax = max(acc.domeMax, value[HISTORY_DOME]);
+    }
+}
+
+// mean of each channel over the interval, returns the valid mask
+uint8_t History::collapse(const Accumulator &acc, int16_t *mean)
+{
+    uint8_t valid = 0;
+
+    for (uint8_t c = 0; c < HISTORY_CHANNELS; c++) {
+        mean[c] = 0;
+        if (acc.n[c] > 0) {
+            // round half away from zero
+            int32_t half = acc.sum[c] >= 0 ? acc.n[c] / 2 : -(acc.n[c] / 2);
+            mean[c] = (acc.sum[c] + half) / acc.n[c];
+            valid |= 1 << c;
+        }
+    }
+    return valid;
+}
+
+// packs the distance from mean to max (high nibble) and to min (low nibble),
+// rounding outwards so the decoded band always contains the real extremes
+uint8_t History::spreadCode(int16_t mean, int16_t lo, int16_t hi) const
+{
+    if (lo > hi) {
+        return 0;
+    }
+    uint8_t up = 0, down = 0;
+    while (up < 15 && spreadSteps[up] < hi - mean) {
+        up++;
+    }
+    while (down < 15 && spreadSteps[down] < mean - lo) {
+        down++;
+    }
+    return (up << 4) | down;
+}
+
+void History::read(uint8_t tier, uint32_t since, HistoryVisitor visit, void *ctx) const
+{
+    switch (tier) {
+    case 0:
+        tier0.read(lastSecond, tierPeriod[0], since, visit, ctx, spreadSteps);
+        break;
+    case 1:
+        // the newest entry ended where the running interval started
+        tier1.read(lastSecond - acc1.slots, tierPeriod[1], since, visit, ctx, spreadSteps);
+        break;
+    case 2:
+        tier2.read(lastSecond - acc2.slots, tierPeriod[2], since, visit, ctx, spreadSteps);
+        break;
+    }
+}
@@ -0,0 +1,206 @@
+#ifndef BGE_HISTORY_HPP
+#define BGE_HISTORY_HPP
+
+#include <Arduino.h>
+
+#include "fixed.hpp"
+
+// In-RAM time series of the cook, kept in three tiers:
+//
+//   tier 0   1 s samples   for the last 5 minutes
+//   tier 1  15 s averages  for the last hour
+//   tier 2   5 min averages for the last 24 hours
+//
+// Values are quantized to 16 bit (temperatures in 1/2 F, fan in whole %)
+// and each ring stores the 8 bit difference from the previous entry plus
+// the absolute value of its oldest entry. A difference too large for 8
+// bits, a lid opening or a fire catching, is escaped: the entry is marked
+// and its absolute value goes to a small side ring, so steps come back
+// exactly. Only when that ring is full is a step clamped, and then spread
+// over the next few entries, as the encoder tracks the value the decoder
+// will reconstruct. Aggregated tiers also keep the dome min/max over the
+// interval as a pair of 4 bit codes, rounded outwards so the band always
+// holds the real extremes but not exactly where they were.
+
+#define HISTORY_CHANNELS 3 // dome, meat, fan
+#define HISTORY_DOME     0
+#define HISTORY_MEAT     1
+#define HISTORY_FAN      2
+
+#define HISTORY_TEMP_SCALE 2 // quantization steps per F
+#define HISTORY_TIERS      3
+#define HISTORY_ESCAPES    16   // large steps per tier kept exactly
+#define HISTORY_BUDGET     3584 // bytes
+
+// one reconstructed entry of a tier
+struct HistoryPoint {
+    uint32_t time;                    // seconds since boot at the end of the interval
+    int16_t  value[HISTORY_CHANNELS]; // mean over the interval, quantized
+    int16_t  domeMin, domeMax;        // equal to the mean on tier 0
+    uint8_t  valid;                   // bit n set when channel n has data
+};
+
+// return false to stop the walk
+typedef bool (*HistoryVisitor)(void *ctx, const HistoryPoint &point);
+
+// a single delta encoded ring
+template <uint16_t CAPACITY, bool SPREAD>
+class HistoryTier
+{
+  public:
+    static const int8_t MISSING = -128;
+    static const int8_t ESCAPE  = -127; // the value is in the escape ring
+    static const int8_t MAXSTEP = 126;
+
+    HistoryTier() : first(0), count(0), escFirst(0), escCount(0)
+    {
+        memset(tail, 0, sizeof(tail));
+        memset(last, 0, sizeof(last));
+        memset(live, 0, sizeof(live));
+    }
+
+    uint16_t size() const { return count; }
+    uint16_t capacity() const { return CAPACITY; }
+
+    // append one entry, dropping the oldest when full
+    void push(const int16_t *value, uint8_t valid, uint8_t spreadCode)
+    {
+        if (count == CAPACITY) {
+            for (uint8_t c = 0; c < HISTORY_CHANNELS; c++) {
+                if (delta[first][c] != MISSING) {
+                    live[c]--;
+                }
+            }
+            first = (first + 1) % CAPACITY;
+            count--;
+            // the new oldest entry becomes the anchor
+            for (uint8_t c = 0; c < HISTORY_CHANNELS; c++) {
+                if (count > 0 && delta[first][c] == ESCAPE) {
+                    tail[c]  = escape[escFirst];
+                    escFirst = (escFirst + 1) % HISTORY_ESCAPES;
+                    escCount--;
+                } else if (count > 0 && delta[first][c] != MISSING) {
+                    tail[c] += delta[first][c];
+                }
+            }
+        }
+
+        uint16_t slot = (first + count) % CAPACITY;
+        for (uint8_t c = 0; c < HISTORY_CHANNELS; c++) {
+            if (!(valid & (1 << c))) {
+                delta[slot][c] = MISSING;
+                continue;
+            }
+            if (live[c] == 0) {
+                // nothing in the ring depends on the anchor, so restart the
+                // channel at its absolute value
+                tail[c] = last[c] = value[c];
+                delta[slot][c] = 0;
+            } else if (abs(value[c] - last[c]) > MAXSTEP && escCount < HISTORY_ESCAPES) {
+                escape[(escFirst + escCount++) % HISTORY_ESCAPES] = value[c];
+                delta[slot][c] = ESCAPE;
+                last[c]        = value[c];
+            } else {
+                int16_t d = constrain(value[c] - last[c], -MAXSTEP, MAXSTEP);
+                delta[slot][c] = d;
+                last[c] += d;
+            }
+            live[c]++;
+        }
+        if (SPREAD) {
+            spread[slot] = spreadCode;
+        }
+        count++;
+    }
+
+    // walk the entries oldest first, newest ending at time now
+    void read(uint32_t now, uint16_t period, uint32_t since, HistoryVisitor visit, void *ctx,
+              const uint8_t *spreadSteps) const
+    {
+        int16_t value[HISTORY_CHANNELS];
+        uint8_t esc = escFirst;
+        memcpy(value, tail, sizeof(value));
+
+        for (uint16_t i = 0; i < count; i++) {
+            uint16_t     slot = (first + i) % CAPACITY;
+            HistoryPoint point;
+            point.valid = 0;
+            for (uint8_t c = 0; c < HISTORY_CHANNELS; c++) {
+                if (delta[slot][c] != MISSING) {
+                    if (i > 0 && delta[slot][c] == ESCAPE) {
+                        value[c] = escape[esc];
+                        esc      = (esc + 1) % HISTORY_ESCAPES;
+                    } else if (i > 0) {
+                        value[c] += delta[slot][c];
+                    }
+                    point.valid |= 1 << c;
+                }
+                point.value[c] = value[c];
+            }
+            point.time    = now - (uint32_t) (count - 1 - i) * period;
+            point.domeMin = point.domeMax = point.value[HISTORY_DOME];
+            if (SPREAD) {
+                point.domeMin -= spreadSteps[spread[slot] & 0x0f];
+                point.domeMax += spreadSteps[spread[slot] >> 4];
+            }
+            if (point.time >= since && !visit(ctx, point)) {
+                return;
+            }
+        }
+    }
+
+  private:
+    int8_t   delta[CAPACITY][HISTORY_CHANNELS];
+    uint8_t  spread[SPREAD ? CAPACITY : 1];
+    int16_t  tail[HISTORY_CHANNELS]; // value of the oldest entry
+    int16_t  last[HISTORY_CHANNELS]; // value of the newest entry as the reader sees it
+    uint16_t live[HISTORY_CHANNELS]; // entries holding data, per channel
+    uint16_t first, count;
+    // absolute values of the escaped entries after the oldest, in order
+    int16_t  escape[HISTORY_ESCAPES];
+    uint8_t  escFirst, escCount;
+};
+
+class History
+{
+  public:
+    History();
+
+    // record the 1 Hz sample for second now, temperatures in 1/16 F with
+    // TEMP_NONE for a bad reading, fan in 0.01 %. Seconds skipped since
+    // the previous call are stored as gaps.
+    void add(uint32_t now, int16_t dome, int16_t meat, uint16_t fan);
+
+    // visit the entries of a tier that end at or after since, oldest first
+    void read(uint8_t tier, uint32_t since, HistoryVisitor visit, void *ctx) const;
+
+    uint16_t period(uint8_t tier) const;
+    uint16_t size(uint8_t tier) const;
+    uint32_t newest() const { return lastSecond; }
+
+  private:
+    // running min/max/mean over one aggregation interval
+    struct Accumulator {
+        int32_t  sum[HISTORY_CHANNELS];
+        uint16_t n[HISTORY_CHANNELS];
+        int16_t  domeMin, domeMax;
+        uint16_t slots;
+    };
+
+    void addSlot(uint32_t second, const int16_t *value, uint8_t valid);
+    void resetAccumulator(Accumulator &acc);
+    void accumulate(Accumulator &acc, const int16_t *value, uint8_t valid);
+    uint8_t collapse(const Accumulator &acc, int16_t *mean);
+    uint8_t spreadCode(int16_t mean, int16_t lo, int16_t hi) const;
+
+    HistoryTier<300, false> tier0;
+    HistoryTier<240, true>  tier1;
+    HistoryTier<288, true>  tier2;
+    Accumulator             acc1, acc2;
+    uint32_t                lastSecond;
+    bool                    started;
+};
+
+static_assert(sizeof(History) <= HISTORY_BUDGET, "history exceeds its RAM budget");
+
+#endif // BGE_HISTORY_HPP
@@ -0,0 +1,112 @@
+#include "httppost.hpp"
+
+#include <ctype.h>
+
+HttpPost::HttpPost(Client &net) : net(net), state(IDLE), host(NULL), len(0), sent(0), got(0), deadline(0)
+{
+}
+
+bool HttpPost::start(const char *host, const char *path, const char *body, size_t len)
+{
+    if (state != IDLE || len > HTTPMAXBODY) {
+        return false;
+    }
+    int n = snprintf(request, HTTPMAXHEAD,
+                     "POST %s HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n"
+                     "Content-Type: application/x-www-form-urlencoded\r\nContent-Length: %u\r\n\r\n",
+                     path, host, (unsigned) len);
+    if (n < 0 || n >= HTTPMAXHEAD) {
+        return false;
+    }
+    memcpy(request + n, body, len);
+    this->host = host;
+    this->len  = n + len;
+    sent       = 0;
+    got        = 0;
+    state      = CONNECT;
+    return true;
+}
+
+int HttpPost::finish(int result)
+{
+    net.stop();
+    state = IDLE;
+    return result;
+}
+
+int HttpPost::poll()
+{
+    switch (state) {
+    case IDLE:
+        return HTTP_PENDING;
+
+    case CONNECT:
+        net.setTimeout(HTTPCONNECTTIMEOUT);
+        if (!net.connect(host, 80)) {
+            return finish(-1);
+        }
+        deadline = millis() + HTTPTIMEOUT;
+        state    = SEND;
+        return HTTP_PENDING;
+
+    case SEND: {
+        // only what the socket takes without waiting
+        size_t n = min((size_t) max(net.availableForWrite(), 0), len - sent);
+        if (n > 0) {
+            sent += net.write((const uint8_t *) request + sent, n);
+        }
+        if (sent == len) {
+            state = RECEIVE;
+        } else if (!net.connected() || (long) (millis() - deadline) >= 0) {
+            return finish(-1);
+        }
+        return HTTP_PENDING;
+    }
+
+    case RECEIVE: {
+        // up to the end of the status line, the server closing or the deadline
+        bool line = false;
+        while (!line && got < sizeof(status) - 1 && net.available() > 0) {
+            int c = net.read();
+            line  = c == '\r' || c == '\n';
+            if (!line) {
+                status[got++] = c;
+            }
+        }
+        if (!line && got < sizeof(status) - 1 && net.connected() && (long) (millis() - deadline) < 0) {
+            return HTTP_PENDING;
+        }
+        status[got]      = '\0';
+        const char *code = strchr(status, ' ');
+        return finish(strncmp(status, "HTTP/", 5) == 0 && code != NULL ? atoi(code + 1) : -2);
+    }
+    }
+    return HTTP_PENDING;
+}
+
+int urlEncode(char *out, size_t outLen, const char *in)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    size_t            n     = 0;
+
+    for (; *in; in++) {
+        uint8_t c = *in;
+        if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+            if (n + 1 >= outLen) {
+                break;
+            }
+            out[n++] = c;
+        } else {
+            if (n + 3 >= outLen) {
+                break;
+            }
+            out[n++] = '%';
+            out[n++] = hex[c >> 4];
+            out[n++] = hex[c & 15];
+        }
+    }
+    if (outLen > 0) {
+        out[n] = '\0';
+    }
+    return *in ? -1 : (int) n;
+}
@@ -0,0 +1,62 @@
+#ifndef BGE_HTTPPOST_HPP
+#define BGE_HTTPPOST_HPP
+
+#include <Arduino.h>
+#include <Client.h>
+
+// Form POSTs for the cloud uploads and notifications, built in fixed
+// buffers. Nothing here touches String or the heap, beyond what lwIP needs
+// for the connection itself.
+//
+// A post is a small state machine polled from loop(), so a slow server
+// holds up a pass by one bounded step at most. The DNS lookup and the TCP
+// connect are the core's blocking calls and each gets HTTPCONNECTTIMEOUT;
+// the request goes out only as fast as the socket takes it, and the reply
+// is read as it arrives, for up to HTTPTIMEOUT.
+
+#define HTTPCONNECTTIMEOUT 1000 // ms for the DNS lookup and for the connect, each
+#define HTTPTIMEOUT        3000 // ms from the connect to the status line
+#define HTTPMAXHEAD        160  // request line and headers
+#define HTTPMAXBODY        160
+
+// poll() while a post is under way
+#define HTTP_PENDING 0
+
+class HttpPost
+{
+  public:
+    HttpPost(Client &net);
+
+    // start a POST of an application/x-www-form-urlencoded body, which is
+    // copied; the host must outlive the post. False while the last post is
+    // still under way or when the request does not fit.
+    bool start(const char *host, const char *path, const char *body, size_t len);
+
+    // take the post a step further, call often from loop(). Returns
+    // HTTP_PENDING until it is done, then once the HTTP status, or a
+    // negative value when no status line came back.
+    int poll();
+
+    bool busy() const { return state != IDLE; }
+
+  private:
+    enum State { IDLE, CONNECT, SEND, RECEIVE };
+
+    int finish(int result);
+
+    Client       &net;
+    State         state;
+    const char   *host;
+    char          request[HTTPMAXHEAD + HTTPMAXBODY];
+    size_t        len;
+    size_t        sent;
+    char          status[16]; // "HTTP/1.1 200 OK", only the code matters
+    uint8_t       got;
+    unsigned long deadline;
+};
+
+// percent-encode in into out, which is always terminated; returns the
+// length, or -1 if it did not fit
+int urlEncode(char *out, size_t outLen, const char *in);
+
+#endif // BGE_HTTPPOST_HPP
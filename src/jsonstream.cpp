@@ -0,0 +1,299 @@
+#include "jsonstream.hpp"
+
+#include <ctype.h>
+
+static bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+JsonStream::JsonStream(Handler handler, void *ctx) : handler(handler), ctx(ctx)
+{
+    reset();
+}
+
+void JsonStream::reset()
+{
+    state     = S_VALUE;
+    inKey     = false;
+    valueType = NONE;
+    depthNow  = 0;
+    keyLen    = 0;
+    valueLen  = 0;
+    unicode   = 0;
+    isArray   = 0;
+    keyBuf[0] = valueBuf[0] = '\0';
+}
+
+uint8_t JsonStream::index() const
+{
+    return depthNow > 0 ? counts[depthNow - 1] : 0;
+}
+
+double JsonStream::number() const
+{
+    return valueType == NUMBER ? strtod(valueBuf, NULL) : NAN;
+}
+
+bool JsonStream::fail()
+{
+    state = S_ERROR;
+    return false;
+}
+
+bool JsonStream::append(char *buf, uint8_t &len, uint8_t size, char c)
+{
+    if (len >= size) {
+        return fail();
+    }
+    buf[len++] = c;
+    buf[len]   = '\0';
+    return true;
+}
+
+void JsonStream::emit(Event event)
+{
+    if (handler) {
+        handler(ctx, *this, event);
+    }
+}
+
+// first character of a value, with the key (if any) already in keyBuf
+bool JsonStream::beginValue(char c)
+{
+    valueLen    = 0;
+    valueBuf[0] = '\0';
+
+    if (c == '{' || c == '[') {
+        if (depthNow >= JSONMAXDEPTH) {
+            return fail();
+        }
+        bool array = c == '[';
+        valueType = NONE;
+        emit(array ? ARRAY_BEGIN : OBJECT_BEGIN);
+        if (array) {
+            isArray |= 1 << depthNow;
+        } else {
+            isArray &= ~(1 << depthNow);
+        }
+        counts[depthNow++] = 0;
+        keyLen    = 0;
+        keyBuf[0] = '\0';
+        state     = array ? S_VALUE_OR_END : S_KEY_OR_END;
+        return true;
+    }
+    if (c == '"') {
+        valueType = STRING;
+        inKey     = false;
+        state     = S_STRING;
+        return true;
+    }
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        valueType = NUMBER;
+        state     = S_NUMBER;
+        return append(valueBuf, valueLen, JSONMAXVALUE, c);
+    }
+    if (c == 't' || c == 'f' || c == 'n') {
+        valueType = c == 'n' ? NUL : BOOLEAN;
+        state     = S_LITERAL;
+        return append(valueBuf, valueLen, JSONMAXVALUE, c);
+    }
+    return fail();
+}
+
+// a scalar is complete
+bool JsonStream::endValue()
+{
+    if (valueType == NUMBER) {
+        // overflow such as 1e999 comes back as inf, which no field takes
+        char  *end;
+        double v = strtod(valueBuf, &end);
+        if (*end != '\0' || !isfinite(v)) {
+            return fail();
+        }
+    } else if (valueType == BOOLEAN) {
+        if (strcmp(valueBuf, "true") != 0 && strcmp(valueBuf, "false") != 0) {
+            return fail();
+        }
+    } else if (valueType == NUL) {
+        if (strcmp(valueBuf, "null") != 0) {
+            return fail();
+        }
+    }
+    emit(VALUE);
+    state = depthNow == 0 ? S_DONE : S_AFTER;
+    return true;
+}
+
+bool JsonStream::closeContainer(char c)
+{
+    bool array = depthNow > 0 && (isArray & (1 << (depthNow - 1)));
+    if (depthNow == 0 || array != (c == ']')) {
+        return fail();
+    }
+    depthNow--;
+    valueType = NONE;
+    emit(array ? ARRAY_END : OBJECT_END);
+    state = depthNow == 0 ? S_DONE : S_AFTER;
+    return true;
+}
+
+bool JsonStream::feed(char c)
+{
+    switch (state) {
+    case S_VALUE:
+        return isSpace(c) || beginValue(c);
+
+    case S_VALUE_OR_END:
+        if (isSpace(c)) {
+            return true;
+        }
+        return c == ']' ? closeContainer(c) : beginValue(c);
+
+    case S_KEY_OR_END:
+        if (c == '}') {
+            return closeContainer(c);
+        }
+        // fall through
+    case S_KEY:
+        if (isSpace(c)) {
+            return true;
+        }
+        if (c != '"') {
+            return fail();
+        }
+        keyLen    = 0;
+        keyBuf[0] = '\0';
+        inKey     = true;
+        state     = S_STRING;
+        return true;
+
+    case S_COLON:
+        if (isSpace(c)) {
+            return true;
+        }
+        if (c != ':') {
+            return fail();
+        }
+        state = S_VALUE;
+        return true;
+
+    case S_STRING:
+        if (unicode > 0) {
+            // non-ASCII code points are not needed by any of our keys or
+            // values, they are kept as a placeholder
+            if (!isxdigit((unsigned char) c)) {
+                return fail();
+            }
+            if (--unicode > 0) {
+                return true;
+            }
+            c = '?';
+        } else if (c == '\\') {
+            state = S_ESCAPE;
+            return true;
+        } else if (c == '"') {
+            if (inKey) {
+                state = S_COLON;
+                return true;
+            }
+            return endValue();
+        } else if ((unsigned char) c < 0x20) {
+            return fail();
+        }
+        return inKey ? append(keyBuf, keyLen, JSONMAXKEY, c) : append(valueBuf, valueLen, JSONMAXVALUE, c);
+
+    case S_ESCAPE:
+        state = S_STRING;
+        switch (c) {
+        case '"':
+        case '\\':
+        case '/': break;
+        case 'b': c = '\b'; break;
+        case 'f': c = '\f'; break;
+        case 'n': c = '\n'; break;
+        case 'r': c = '\r'; break;
+        case 't': c = '\t'; break;
+        case 'u': unicode = 4; return true;
+        default: return fail();
+        }
+        return inKey ? append(keyBuf, keyLen, JSONMAXKEY, c) : append(valueBuf, valueLen, JSONMAXVALUE, c);
+
+    case S_NUMBER:
+        if ((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') {
+            return append(valueBuf, valueLen, JSONMAXVALUE, c);
+        }
+        // the terminating character belongs to whatever follows the number
+        return endValue() && feed(c);
+
+    case S_LITERAL:
+        if (c >= 'a' && c <= 'z') {
+            return append(valueBuf, valueLen, JSONMAXVALUE, c);
+        }
+        return endValue() && feed(c);
+
+    case S_AFTER:
+        if (isSpace(c)) {
+            return true;
+        }
+        if (c == '}' || c == ']') {
+            return closeContainer(c);
+        }
+        if (c != ',') {
+            return fail();
+        }
+        counts[depthNow - 1]++;
+        if (isArray & (1 << (depthNow - 1))) {
+            keyLen    = 0;
+            keyBuf[0] = '\0';
+            state     = S_VALUE;
+        } else {
+            state = S_KEY;
+        }
+        return true;
+
+    case S_DONE:
+        return isSpace(c) || fail();
+
+    case S_ERROR:
+    default:
+        return false;
+    }
+}
+
+bool JsonStream::feed(const char *s, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        if (!feed(s[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool JsonStream::finish()
+{
+    // a bare top level number or literal has no terminator of its own
+    if ((state == S_NUMBER || state == S_LITERAL) && depthNow == 0) {
+        endValue();
+    }
+    return state == S_DONE;
+}
+
+const char *jsonNumber(char *buf, size_t len, double v, int decimals)
+{
+    if (isnan(v) || isinf(v)) {
+        return "null";
+    }
+    snprintf(buf, len, "%.*f", decimals, v);
+    return buf;
+}
+
+const char *jsonTemp(char *buf, size_t len, int16_t t, int decimals)
+{
+    if (t == TEMP_NONE) {
+        return "null";
+    }
+    fmtFixed(buf, len, t, TEMP_SHIFT, decimals);
+    return buf;
+}
@@ -0,0 +1,81 @@
+#ifndef BGE_JSONSTREAM_HPP
+#define BGE_JSONSTREAM_HPP
+
+#include <Arduino.h>
+
+#include "fixed.hpp"
+
+// Streaming (SAX style) JSON parser with fixed buffers and no heap use.
+//
+// Characters are fed in one at a time and the handler is called for every
+// object/array boundary and scalar value as soon as it is complete, so a
+// request body never has to be held as a document tree. Keys and values
+// longer than the fixed buffers make the parse fail rather than truncate.
+
+#define JSONMAXDEPTH 8
+#define JSONMAXKEY   16
+#define JSONMAXVALUE 24
+
+class JsonStream
+{
+  public:
+    enum Event { OBJECT_BEGIN, OBJECT_END, ARRAY_BEGIN, ARRAY_END, VALUE };
+    enum Type { NONE, NUMBER, STRING, BOOLEAN, NUL };
+
+    typedef void (*Handler)(void *ctx, const JsonStream &json, Event event);
+
+    JsonStream(Handler handler, void *ctx);
+
+    void reset();
+    // feed the next input character, false once the input is malformed
+    bool feed(char c);
+    bool feed(const char *s, size_t len);
+    // end of input, true if exactly one complete value was parsed
+    bool finish();
+
+    bool failed() const { return state == S_ERROR; }
+
+    // valid inside the handler
+    const char *key() const { return keyBuf; }     // member name, "" inside arrays
+    uint8_t     depth() const { return depthNow; } // 1 for members of the top level object
+    uint8_t     index() const;                     // position within the enclosing array
+    Type        type() const { return valueType; }
+    const char *text() const { return valueBuf; }  // raw string contents or number text
+    double      number() const;
+    bool        boolean() const { return valueBuf[0] == 't'; }
+    bool        isKey(const char *name) const { return strcmp(keyBuf, name) == 0; }
+
+  private:
+    enum State {
+        S_VALUE, S_VALUE_OR_END, S_KEY_OR_END, S_KEY, S_KEY_STRING, S_COLON,
+        S_STRING, S_ESCAPE, S_NUMBER, S_LITERAL, S_AFTER, S_DONE, S_ERROR
+    };
+
+    bool fail();
+    bool beginValue(char c);
+    bool endValue();
+    bool closeContainer(char c);
+    bool append(char *buf, uint8_t &len, uint8_t size, char c);
+    void emit(Event event);
+
+    Handler handler;
+    void   *ctx;
+    State   state;
+    bool    inKey;
+    Type    valueType;
+    uint8_t depthNow;
+    uint8_t keyLen, valueLen;
+    uint8_t unicode; // hex digits left to skip in a \u escape
+    uint8_t isArray; // bit n set when level n+1 is an array
+    uint8_t counts[JSONMAXDEPTH];
+    char    keyBuf[JSONMAXKEY + 1];
+    char    valueBuf[JSONMAXVALUE + 1];
+};
+
+// formats v as a JSON number, or null when the reading is bad
+const char *jsonNumber(char *buf, size_t len, double v, int decimals);
+
+// the same for a temperature in 1/16 F, without floating point
+const char *jsonTemp(char *buf, size_t len, int16_t t, int decimals);
+
+#endif // BGE_JSONSTREAM_HPP
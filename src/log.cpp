@@ -0,0 +1,173 @@
+#include "log.hpp"
+
+#include <Schedule.h>
+#include <stdarg.h>
+
+LogLevel logLevel = LOG_INFO;
+
+static char     ring[LOGRING];
+static uint16_t head = 0; // next byte to write
+static uint16_t tail = 0; // next byte to send
+static LogStats stats;
+
+static const char *const levelNames[]   = { "error", "warn", "info", "debug" };
+static const char        levelLetters[] = "EWID";
+
+static_assert((LOGRING & (LOGRING - 1)) == 0, "log ring size must be a power of two");
+
+static size_t ringFree()
+{
+    return LOGRING - 1 - ((head - tail) & (LOGRING - 1));
+}
+
+// messages go in all or nothing, so the UART never sees half of one
+static bool ringRoom(size_t n)
+{
+    if (n > ringFree()) {
+        stats.dropped++;
+        return false;
+    }
+    stats.written++;
+    return true;
+}
+
+static void ringCopy(const void *data, size_t n)
+{
+    const char *p = (const char *) data;
+    for (size_t i = 0; i < n; i++) {
+        ring[head] = p[i];
+        head       = (head + 1) & (LOGRING - 1);
+    }
+}
+
+// CRC-8, polynomial 0x07
+static uint8_t crc8(uint8_t crc, const uint8_t *p, size_t n)
+{
+    while (n--) {
+        crc ^= *p++;
+        for (int i = 0; i < 8; i++) {
+            crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+void logBegin()
+{
+    Serial.begin(LOGBAUD);
+    // runs at every yield as well as between loop() passes
+    schedule_recurrent_function_us(logDrain, 0);
+}
+
+void logPrintf_P(LogLevel level, PGM_P fmt, ...)
+{
+    if (level > logLevel) {
+        return;
+    }
+
+    char prefix[16];
+    char line[LOGLINE];
+    int  plen = snprintf(prefix, sizeof(prefix), "%lu %c ", millis(), levelLetters[level]);
+
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf_P(line, sizeof(line) - 1, fmt, args);
+    va_end(args);
+
+    if (n < 0) {
+        return;
+    }
+    n         = min(n, (int) sizeof(line) - 2);
+    line[n++] = '\n';
+    if (ringRoom(plen + n)) {
+        ringCopy(prefix, plen);
+        ringCopy(line, n);
+    }
+}
+
+void logWrite(LogLevel level, const char *text, size_t len)
+{
+    if (level > logLevel) {
+        return;
+    }
+#if LOGBINARY
+    logFrame(level, 0, (const uint8_t *) text, min(len, (size_t) LOGLINE));
+#else
+    if (ringRoom(len)) {
+        ringCopy(text, len);
+    }
+#endif
+}
+
+void LogArgs::put(const void *data, size_t n)
+{
+    n = min(n, sizeof(buf) - len);
+    memcpy(buf + len, data, n);
+    len += n;
+}
+
+void logArg(LogArgs &a, const char *s)
+{
+    if (a.len == sizeof(a.buf)) {
+        return;
+    }
+    uint8_t n = min(strlen(s), sizeof(a.buf) - a.len - 1);
+    a.put(&n, 1);
+    a.put(s, n);
+}
+
+void logFrame(LogLevel level, uint32_t id, const uint8_t *args, size_t len)
+{
+    uint8_t  header[11];
+    uint32_t ms = millis();
+
+    header[0] = LOGSYNC;
+    header[1] = 9 + len;
+    header[2] = level;
+    memcpy(header + 3, &ms, 4);
+    memcpy(header + 7, &id, 4);
+
+    uint8_t crc = crc8(crc8(0, header + 2, 9), args, len);
+    if (ringRoom(sizeof(header) + len + 1)) {
+        ringCopy(header, sizeof(header));
+        ringCopy(args, len);
+        ringCopy(&crc, 1);
+    }
+}
+
+bool logDrain()
+{
+    int room = Serial.availableForWrite();
+
+    while (room > 0 && tail != head) {
+        // the contiguous run up to the write position or the end of the ring
+        size_t run = head > tail ? head - tail : LOGRING - tail;
+        run        = min(run, (size_t) room);
+        Serial.write((const uint8_t *) ring + tail, run);
+        tail  = (tail + run) & (LOGRING - 1);
+        room -= run;
+    }
+    return true; // keep running
+}
+
+const LogStats &logStats()
+{
+    stats.queued = (head - tail) & (LOGRING - 1);
+    return stats;
+}
+
+const char *logLevelName(LogLevel level)
+{
+    return levelNames[level];
+}
+
+bool logLevelParse(const char *name, LogLevel &level)
+{
+    for (uint8_t i = 0; i <= LOG_DEBUG; i++) {
+        if (strcasecmp(name, levelNames[i]) == 0) {
+            level = (LogLevel) i;
+            return true;
+        }
+    }
+    return false;
+}
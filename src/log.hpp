@@ -0,0 +1,133 @@
+#ifndef BGE_LOG_HPP
+#define BGE_LOG_HPP
+
+#include <Arduino.h>
+
+// Leveled serial log. Messages go into a RAM ring and drain to the UART
+// only as fast as its FIFO takes them, so logging never waits on the wire.
+// When the ring is full a message is dropped and counted.
+//
+//   logInfo("wifi up in %lums", ms);
+//
+// With LOGBINARY the device does no formatting at all. Each message goes
+// out as a frame holding a 32-bit hash of its format string and the raw
+// arguments, and scripts/logdecode.py turns frames back into text using a
+// table that scripts/logtable.py builds from the log calls in src/. The
+// format strings never reach the firmware image.
+//
+// A frame is
+//
+//   0xb6, length, level, millis (u32), id (u32), arguments, CRC-8
+//
+// with length counting level through arguments, all little-endian.
+// Integers and pointers go as 4 bytes, floating point as a float, strings
+// as a length byte and the text. Id 0 carries raw text from logWrite().
+//
+// Without LOGBINARY, lines read "<millis> <level letter> <message>" and
+// format strings stay in flash.
+//
+// Call from loop() or scheduled functions, never from an ISR.
+
+#define LOGBAUD   115200
+#define LOGRING   1024 // bytes
+#define LOGLINE   96   // longest message or argument block, longer ones are cut
+#define LOGBINARY 1
+
+#define LOGSYNC 0xb6
+
+enum LogLevel { LOG_ERROR, LOG_WARN, LOG_INFO, LOG_DEBUG };
+
+struct LogStats {
+    uint32_t written; // messages queued
+    uint32_t dropped; // messages lost to a full ring
+    uint16_t queued;  // bytes waiting for the UART
+};
+
+extern LogLevel logLevel;
+
+#if LOGBINARY
+#define logAt(level, fmt, ...)                                 \
+    do {                                                       \
+        if (0) {                                               \
+            logCheckFormat(fmt, ##__VA_ARGS__);                \
+        }                                                      \
+        constexpr uint32_t logId_ = logHash(fmt);              \
+        logEmit(level, logId_, ##__VA_ARGS__);                 \
+    } while (0)
+#else
+#define logAt(level, fmt, ...) logPrintf_P(level, PSTR(fmt), ##__VA_ARGS__)
+#endif
+
+#define logError(fmt, ...) logAt(LOG_ERROR, fmt, ##__VA_ARGS__)
+#define logWarn(fmt, ...)  logAt(LOG_WARN, fmt, ##__VA_ARGS__)
+#define logInfo(fmt, ...)  logAt(LOG_INFO, fmt, ##__VA_ARGS__)
+#define logDebug(fmt, ...) logAt(LOG_DEBUG, fmt, ##__VA_ARGS__)
+
+// open the UART and start draining the ring
+void logBegin();
+
+void logPrintf_P(LogLevel level, PGM_P fmt, ...) __attribute__((format(printf, 2, 3)));
+
+// queue text as it is, without the prefix or a line end
+void logWrite(LogLevel level, const char *text, size_t len);
+
+// move what the UART can take right now; always true, logBegin() runs it
+// as a recurrent scheduled function
+bool logDrain();
+
+const LogStats &logStats();
+
+// "error", "warn", "info" or "debug"
+const char *logLevelName(LogLevel level);
+bool        logLevelParse(const char *name, LogLevel &level);
+
+// FNV-1a, the message id in binary frames; scripts/logtable.py must agree
+constexpr uint32_t logHash(const char *s, uint32_t h = 2166136261u)
+{
+    return *s ? logHash(s + 1, (h ^ (uint8_t) *s) * 16777619u) : h;
+}
+
+// never called, lets the compiler check arguments against the format
+inline void logCheckFormat(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+inline void logCheckFormat(const char *, ...) {}
+
+// argument bytes of one binary frame
+struct LogArgs {
+    uint8_t buf[LOGLINE];
+    uint8_t len;
+
+    LogArgs() : len(0) {}
+    void put(const void *data, size_t n);
+};
+
+inline void logArg(LogArgs &a, int v) { a.put(&v, 4); }
+inline void logArg(LogArgs &a, unsigned int v) { a.put(&v, 4); }
+inline void logArg(LogArgs &a, long v) { int32_t w = v; a.put(&w, 4); }
+inline void logArg(LogArgs &a, unsigned long v) { uint32_t w = v; a.put(&w, 4); }
+inline void logArg(LogArgs &a, double v) { float f = v; a.put(&f, 4); }
+void logArg(LogArgs &a, const char *s);
+
+inline void logArgs(LogArgs &) {}
+
+template <typename T, typename... Rest>
+void logArgs(LogArgs &a, T v, Rest... rest)
+{
+    logArg(a, v);
+    logArgs(a, rest...);
+}
+
+// queue one binary frame
+void logFrame(LogLevel level, uint32_t id, const uint8_t *args, size_t len);
+
+template <typename... Args>
+void logEmit(LogLevel level, uint32_t id, Args... args)
+{
+    if (level > logLevel) {
+        return;
+    }
+    LogArgs a;
+    logArgs(a, args...);
+    logFrame(level, id, a.buf, a.len);
+}
+
+#endif // BGE_LOG_HPP
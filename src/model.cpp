@@ -0,0 +1,193 @@
+#include "model.hpp"
+
+#include "bgemonitor.hpp"
+#include "mpc.hpp"
+
+// temperatures enter the regression in hundreds of F, so all three
+// regressors are of similar size
+#define MODEL_SCALE 100.0f
+// covariance trace beyond which forgetting pauses, keeps P bounded while
+// the grill sits at steady state and teaches the model nothing
+#define MODEL_MAXTRACE 1e4f
+// prediction error, in F, too small to learn from. At steady state the
+// regressors barely move and forgetting would let the parameters wander
+// along combinations that predict equally well; skipping those samples
+// keeps a, b and c meaningful
+#define MODEL_DEADBAND 1.0f
+
+FopdtModel domeModel;
+bool       feedForwardEnabled = true;
+
+static float         dutySum = 0;
+static uint16_t      dutyCount = 0;
+static unsigned long nextModelSample = 0;
+
+FopdtModel::FopdtModel()
+{
+    reset();
+}
+
+void FopdtModel::reset()
+{
+    // a slow grill that heats with the fan as a starting guess
+    theta[0] = 0.98f;
+    theta[1] = 0.1f;
+    theta[2] = 0.04f;
+    memset(P, 0, sizeof(P));
+    for (int i = 0; i < 3; i++) {
+        P[i][i] = 100;
+    }
+    for (int i = 0; i <= MODEL_DEADTIME; i++) {
+        history[i] = 0;
+    }
+    lastTemp = NAN;
+    count    = 0;
+}
+
+void FopdtModel::update(float duty, float temp)
+{
+    float y = temp / MODEL_SCALE;
+
+    // history[0] is the newest duty, history[MODEL_DEADTIME] the one that
+    // acts on the temperature now
+    memmove(history + 1, history, MODEL_DEADTIME * sizeof(float));
+    history[0] = duty;
+
+    if (isnan(lastTemp)) {
+        lastTemp = y;
+        return;
+    }
+    float phi[3] = { lastTemp, history[MODEL_DEADTIME], 1 };
+    lastTemp     = y;
+
+    float trace = 0;
+    for (int i = 0; i < 3; i++) {
+        trace += P[i][i];
+    }
+    float forget = trace < MODEL_MAXTRACE ? MODEL_FORGET : 1;
+
+    float Pphi[3], denom = forget;
+    for (int i = 0; i < 3; i++) {
+        Pphi[i] = P[i][0] * phi[0] + P[i][1] * phi[1] + P[i][2] * phi[2];
+        denom  += phi[i] * Pphi[i];
+    }
+    float error = y - (theta[0] * phi[0] + theta[1] * phi[1] + theta[2] * phi[2]);
+    count++;
+    if (fabsf(error) * MODEL_SCALE < MODEL_DEADBAND) {
+        return;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        float k   = Pphi[i] / denom;
+        theta[i] += k * error;
+        for (int j = 0; j < 3; j++) {
+            // P is symmetric, so phi' P is Pphi transposed
+            P[i][j] = (P[i][j] - k * Pphi[j]) / forget;
+        }
+    }
+}
+
+bool FopdtModel::trusted() const
+{
+    float k = gain();
+    return count >= MODEL_MINSAMPLES && theta[0] > 0.5f && theta[0] < 0.9999f && theta[1] > 0 && k > 100 &&
+           k < 5000;
+}
+
+float FopdtModel::gain() const
+{
+    return theta[1] / (1 - theta[0]) * MODEL_SCALE;
+}
+
+float FopdtModel::timeConstant() const
+{
+    return -(MODEL_PERIOD / 1000.0f) / logf(theta[0]);
+}
+
+float FopdtModel::ambient() const
+{
+    return theta[2] / (1 - theta[0]) * MODEL_SCALE;
+}
+
+float FopdtModel::predict(float temp, float duty) const
+{
+    return (theta[0] * temp / MODEL_SCALE + theta[1] * duty + theta[2]) * MODEL_SCALE;
+}
+
+float FopdtModel::dutyFor(float temp, float next) const
+{
+    return ((next - theta[0] * temp) / MODEL_SCALE - theta[2]) / theta[1];
+}
+
+void FopdtModel::coefficients(float &a, float &b, float &c) const
+{
+    a = theta[0];
+    b = theta[1] * MODEL_SCALE;
+    c = theta[2] * MODEL_SCALE;
+}
+
+// The feed-forward runs the model ahead of the real dome: each sample it
+// picks the duty that moves the model along a first-order path to the
+// setpoint, and the model's answer, dead time later, is what the PID is
+// asked to track. The PID then only sees where the grill strays from the
+// model instead of the whole setpoint change, which the feed-forward is
+// already answering.
+static float reference[MODEL_DEADTIME + 1]; // model temperatures, [0] newest
+static float feedDuty = 0;
+static bool  feeding  = false;
+
+static void feedForwardStep(float temp)
+{
+    if (!feedForwardEnabled || !domeModel.trusted() || domePID.GetMode() != AUTOMATIC || mpcActive()) {
+        feeding  = false;
+        feedDuty = 0;
+        return;
+    }
+    if (!feeding) {
+        // start from the dome as it is, as if it had been there a while
+        for (int i = 0; i <= MODEL_DEADTIME; i++) {
+            reference[i] = temp;
+        }
+        feeding = true;
+    }
+    float now  = reference[0];
+    float want = now + (domeTarget - now) * (1 - expf(-(MODEL_PERIOD / 1000.0f) / MODEL_REFTAU));
+    // the fan cannot do better than full or off, and then the model moves
+    // as far as it can
+    feedDuty = constrain(domeModel.dutyFor(now, want), 0.0f, 1.0f);
+    memmove(reference + 1, reference, MODEL_DEADTIME * sizeof(float));
+    reference[0] = domeModel.predict(now, feedDuty);
+}
+
+void modelSample(double duty, double temp)
+{
+    dutySum += duty;
+    dutyCount++;
+    if ((long) (millis() - nextModelSample) < 0) {
+        return;
+    }
+    nextModelSample = millis() + MODEL_PERIOD;
+
+    // a bad reading costs the model one sample, not a poisoned fit
+    if (dutyCount > 0 && !isnan(temp)) {
+        domeModel.update(dutySum / dutyCount, temp);
+        feedForwardStep(temp);
+    }
+    dutySum   = 0;
+    dutyCount = 0;
+}
+
+bool feedForwardActive()
+{
+    return feeding;
+}
+
+double feedForwardOutput()
+{
+    return feeding ? feedDuty * FANWINDOW : 0;
+}
+
+double feedForwardReference()
+{
+    return feeding ? reference[MODEL_DEADTIME] : domeTarget;
+}
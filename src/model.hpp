@@ -0,0 +1,79 @@
+#ifndef BGE_MODEL_HPP
+#define BGE_MODEL_HPP
+
+#include <Arduino.h>
+
+// Online model of the grill and the fan feed-forward built on it.
+//
+// The dome is treated as first order plus dead time, sampled once per fan
+// window:
+//
+//   T[k+1] = a T[k] + b u[k-d] + c
+//
+// with u the fan duty (0-1) and d a fixed dead time. Recursive least
+// squares with forgetting keeps a, b and c current as the charcoal burns
+// down.
+//
+// Once the fit is trusted the model drives the fan directly: inverted, it
+// gives the duty that takes the dome to the setpoint along a first-order
+// path of MODEL_REFTAU, and that duty is added to the PID's. The PID is
+// given the model's temperature instead of the setpoint, so it corrects
+// only what the model gets wrong.
+
+#define MODEL_PERIOD     FANWINDOW // ms per model sample
+#define MODEL_DEADTIME   3         // samples between a duty change and the first response
+#define MODEL_FORGET     0.995f    // RLS forgetting factor, ~200 samples of memory
+#define MODEL_MINSAMPLES 30        // before the model is trusted
+#define MODEL_REFTAU     200.0f    // s, time constant asked of the dome after a setpoint change
+
+class FopdtModel
+{
+  public:
+    FopdtModel();
+
+    void reset();
+
+    // one sample: mean duty over the period and the temperature at its end
+    void update(float duty, float temp);
+
+    // enough data, and parameters a real grill could have
+    bool trusted() const;
+
+    float gain() const;         // F per unit duty at steady state
+    float timeConstant() const; // seconds
+    float ambient() const;      // F with the fan off
+
+    // temperature one sample on, with duty applied a dead time ago
+    float predict(float temp, float duty) const;
+    // duty that takes temp to next in one sample, unclamped
+    float dutyFor(float temp, float next) const;
+    // T[k+1] = a T[k] + b u[k-d] + c, in F
+    void coefficients(float &a, float &b, float &c) const;
+
+    uint32_t samples() const { return count; }
+
+  private:
+    float    theta[3]; // a, b, c; temperatures in hundreds of F
+    float    P[3][3];
+    float    history[MODEL_DEADTIME + 1];
+    float    lastTemp;
+    uint32_t count;
+};
+
+extern FopdtModel domeModel;
+extern bool       feedForwardEnabled;
+
+// account one control pass, call from the control task
+void modelSample(double duty, double temp);
+
+// enabled, the model trusted, domePID in AUTOMATIC and the MPC not in
+// charge, as of the last model sample
+bool feedForwardActive();
+
+// feed-forward fan output in ms per window, 0 while not active
+double feedForwardOutput();
+
+// dome temperature for domePID to hold, domeTarget while not active
+double feedForwardReference();
+
+#endif // BGE_MODEL_HPP
@@ -0,0 +1,134 @@
+#include "mpc.hpp"
+
+#include "bgemonitor.hpp"
+
+double  mpcOutput;
+DomeMpc domeMpc(&domeTempF, &mpcOutput, &domeTarget);
+bool    mpcEnabled = false;
+
+// first horizon sample of each duty level
+static const uint8_t blockStart[MPC_MOVES] = { 0, 1, 3 };
+
+static int blockOf(int i)
+{
+    int m = MPC_MOVES - 1;
+    while (i < blockStart[m]) {
+        m--;
+    }
+    return m;
+}
+
+DomeMpc::DomeMpc(double *in, double *out, double *sp)
+    : input(in), output(out), setpoint(sp), disturbance(0), expected(NAN), nextRun(0), solveTime(0)
+{
+    for (int i = 0; i < MODEL_DEADTIME; i++) {
+        past[i] = 0;
+    }
+    for (int m = 0; m < MPC_MOVES; m++) {
+        moves[m] = 0;
+    }
+}
+
+void DomeMpc::start()
+{
+    // the duties in the dead time were whatever the fan is doing now
+    float duty = constrain(*output / FANWINDOW, 0.0, 1.0);
+    for (int i = 0; i < MODEL_DEADTIME; i++) {
+        past[i] = duty;
+    }
+    for (int m = 0; m < MPC_MOVES; m++) {
+        moves[m] = duty;
+    }
+    disturbance = 0;
+    expected    = NAN;
+    nextRun     = millis();
+}
+
+bool DomeMpc::Compute()
+{
+    if ((long) (millis() - nextRun) < 0) {
+        return false;
+    }
+    nextRun = millis() + MODEL_PERIOD;
+
+    float y = *input;
+    if (isnan(y)) {
+        return false; // hold the fan where it is
+    }
+    unsigned long start = micros();
+
+    float a, b, c;
+    domeModel.coefficients(a, b, c);
+
+    // whatever the model keeps missing is taken to carry on
+    if (!isnan(expected)) {
+        disturbance += MPC_DISTGAIN * (y - expected);
+    }
+    c += disturbance;
+
+    // Predict the horizon as f + G v, f with every future duty at zero and
+    // column m of G the response to level m alone, and accumulate the QP
+    // terms on the way: H = G'G, q = -G'(r - f).
+    float H[MPC_MOVES][MPC_MOVES], q[MPC_MOVES], g[MPC_MOVES];
+    float f = y;
+    float r = *setpoint;
+    memset(H, 0, sizeof(H));
+    for (int m = 0; m < MPC_MOVES; m++) {
+        q[m] = g[m] = 0;
+    }
+    for (int j = 0; j < MPC_HORIZON; j++) {
+        // the duty acting on sample j + 1 is i samples from now
+        int i = j - MODEL_DEADTIME;
+        f     = a * f + c + (i < 0 ? b * past[j] : 0);
+        for (int m = 0; m < MPC_MOVES; m++) {
+            g[m] = a * g[m] + (i >= 0 && blockOf(i) == m ? b : 0);
+        }
+        float error = r - f;
+        for (int m = 0; m < MPC_MOVES; m++) {
+            q[m] -= g[m] * error;
+            for (int n = 0; n <= m; n++) {
+                H[m][n] += g[m] * g[n];
+            }
+        }
+    }
+
+    // moves cost (v0 - u)^2 + (v1 - v0)^2 + (v2 - v1)^2, u the duty now
+    float duty = constrain(*output / FANWINDOW, 0.0, 1.0);
+    for (int m = 0; m < MPC_MOVES; m++) {
+        H[m][m] += MPC_MOVEWEIGHT * (m < MPC_MOVES - 1 ? 2 : 1);
+        if (m > 0) {
+            H[m][m - 1] -= MPC_MOVEWEIGHT;
+        }
+        for (int n = 0; n < m; n++) {
+            H[n][m] = H[m][n];
+        }
+    }
+    q[0] -= MPC_MOVEWEIGHT * duty;
+
+    // minimise v'Hv + 2q'v over 0 <= v <= 1; H is positive definite, so
+    // each coordinate step lowers the cost and the sweeps converge
+    for (int sweep = 0; sweep < MPC_SWEEPS; sweep++) {
+        for (int m = 0; m < MPC_MOVES; m++) {
+            float s = -q[m];
+            for (int n = 0; n < MPC_MOVES; n++) {
+                if (n != m) {
+                    s -= H[m][n] * moves[n];
+                }
+            }
+            moves[m] = constrain(s / H[m][m], 0.0f, 1.0f);
+        }
+    }
+
+    expected = a * y + b * past[0] + c;
+    memmove(past, past + 1, (MODEL_DEADTIME - 1) * sizeof(float));
+    past[MODEL_DEADTIME - 1] = moves[0];
+    *output                  = moves[0] * FANWINDOW;
+
+    solveTime = micros() - start;
+    return true;
+}
+
+bool mpcActive()
+{
+    return mpcEnabled && domeModel.trusted() && domePID.GetMode() == AUTOMATIC;
+}
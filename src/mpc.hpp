@@ -0,0 +1,64 @@
+#ifndef BGE_MPC_HPP
+#define BGE_MPC_HPP
+
+#include <Arduino.h>
+
+#include "model.hpp"
+
+// Model predictive control of the dome, an alternative to domePID.
+//
+// Once per fan window the identified model (model.hpp) predicts the dome
+// MPC_HORIZON samples ahead, from the measured temperature and the duties
+// already on their way through the dead time. The future duty is three
+// levels, held for one sample, two samples and the rest of the horizon.
+// The levels minimise squared tracking error plus MPC_MOVEWEIGHT times
+// the squared duty moves, with 0 <= duty <= 1. That is a 3x3 box
+// constrained QP, solved by projected Gauss-Seidel warm started from the
+// last answer. A filtered one-step prediction error is carried as a
+// constant disturbance, so model error does not leave an offset.
+//
+// The work is a few hundred float operations every FANWINDOW ms. Between
+// windows Compute() only checks the clock.
+
+#define MPC_HORIZON    48      // samples predicted, 8 minutes
+#define MPC_MOVES      3       // duty levels over the horizon
+#define MPC_MOVEWEIGHT 10000.0f // F^2 per unit duty^2 moved
+#define MPC_SWEEPS     12      // Gauss-Seidel passes per solve
+#define MPC_DISTGAIN   0.1f    // share of each prediction error taken into the disturbance
+
+class DomeMpc
+{
+  public:
+    // same wiring as DomePid: reads *input and *setpoint, writes *output in
+    // ms per fan window
+    DomeMpc(double *in, double *out, double *sp);
+
+    // like DomePid::Compute(), true when a new output was written
+    bool Compute();
+
+    // take over the fan without a jump, from *output as it stands
+    void start();
+
+    // time the last solve took
+    unsigned long solveMicros() const { return solveTime; }
+
+  private:
+    double       *input, *output, *setpoint;
+    float         past[MODEL_DEADTIME]; // duties still in the dead time, [0] oldest
+    float         moves[MPC_MOVES];
+    float         disturbance;
+    float         expected; // this sample's temperature as predicted last time
+    unsigned long nextRun;
+    unsigned long solveTime;
+};
+
+extern DomeMpc domeMpc;
+extern bool    mpcEnabled;
+// the MPC's fan command in ms per window, which controlTick rate limits
+// into fanOutput
+extern double mpcOutput;
+
+// enabled, the model trusted and domePID in AUTOMATIC
+bool mpcActive();
+
+#endif // BGE_MPC_HPP
@@ -0,0 +1,298 @@
+#include "mqtt.hpp"
+
+#define MQTT_CONNECT    0x10
+#define MQTT_CONNACK    0x20
+#define MQTT_PUBLISH    0x30
+#define MQTT_PUBACK     0x40
+#define MQTT_PINGREQ    0xc0
+#define MQTT_PINGRESP   0xd0
+#define MQTT_DISCONNECT 0xe0
+
+#define MQTT_QOS1 0x02
+#define MQTT_DUP  0x08
+
+// stages of the incoming packet parser
+#define RX_HEADER 0
+#define RX_LENGTH 1
+#define RX_BODY   2
+
+// writes the variable length "remaining length", returns bytes used
+static uint8_t putLength(uint8_t *p, uint32_t len)
+{
+    uint8_t n = 0;
+    do {
+        uint8_t b = len % 128;
+        len /= 128;
+        p[n++] = len > 0 ? b | 0x80 : b;
+    } while (len > 0);
+    return n;
+}
+
+static uint8_t *putString(uint8_t *p, const char *s, size_t len)
+{
+    *p++ = len >> 8;
+    *p++ = len & 0xff;
+    memcpy(p, s, len);
+    return p + len;
+}
+
+MqttClient::MqttClient(Client &net) :
+    net(net), host(NULL), port(1883), clientId(""), state(IDLE), stateSince(0), lastSend(0), pingAt(0), retryAt(0),
+    retryDelay(MQTT_RETRY_MIN), pingOut(false), nextId(1), first(0), pending(0), rxStage(RX_HEADER)
+{
+    memset(&counters, 0, sizeof(counters));
+}
+
+void MqttClient::begin(const char *host, uint16_t port, const char *clientId)
+{
+    this->host     = host;
+    this->port     = port;
+    this->clientId = clientId;
+}
+
+bool MqttClient::send(const uint8_t *buf, size_t len)
+{
+    // never park the loop behind a full socket
+    if (net.availableForWrite() < (int) len) {
+        return false;
+    }
+    if (net.write(buf, len) != len) {
+        return false;
+    }
+    lastSend = millis();
+    return true;
+}
+
+void MqttClient::connect()
+{
+    if (!net.connect(host, port)) {
+        retryAt    = millis() + retryDelay;
+        retryDelay = min(retryDelay * 2, (unsigned long) MQTT_RETRY_MAX);
+        return;
+    }
+
+    uint8_t  packet[MQTT_MAXPACKET];
+    size_t   idLen = min(strlen(clientId), (size_t) 23); // the 3.1.1 limit brokers must accept
+    uint32_t remaining = 10 + 2 + idLen;
+    uint8_t *p = packet;
+
+    *p++ = MQTT_CONNECT;
+    p   += putLength(p, remaining);
+    p    = putString(p, "MQTT", 4);
+    *p++ = 4;    // protocol level 3.1.1
+    *p++ = 0x00; // clean session off: the broker keeps our session
+    *p++ = MQTT_KEEPALIVE >> 8;
+    *p++ = MQTT_KEEPALIVE & 0xff;
+    p    = putString(p, clientId, idLen);
+
+    rxStage = RX_HEADER;
+    pingOut = false;
+    if (!send(packet, p - packet)) {
+        drop();
+        return;
+    }
+    state      = CONNECTING;
+    stateSince = millis();
+}
+
+void MqttClient::drop()
+{
+    net.stop();
+    state      = IDLE;
+    retryAt    = millis() + retryDelay;
+    retryDelay = min(retryDelay * 2, (unsigned long) MQTT_RETRY_MAX);
+}
+
+// after a reconnect the broker expects every unacknowledged PUBLISH again
+void MqttClient::resend()
+{
+    for (uint8_t i = 0; i < pending; i++) {
+        Slot &slot = window[(first + i) % MQTT_WINDOW];
+        if (slot.acked) {
+            continue;
+        }
+        if (slot.sent) {
+            slot.packet[0] |= MQTT_DUP;
+            counters.resent++;
+        }
+        if (!send(slot.packet, slot.len)) {
+            // out of socket space, the ack timeout brings us back here
+            return;
+        }
+        slot.sent   = true;
+        slot.sentAt = millis();
+    }
+}
+
+bool MqttClient::publish(const char *topic, const uint8_t *payload, size_t len)
+{
+    size_t   topicLen  = strlen(topic);
+    uint32_t remaining = 2 + topicLen + 2 + len;
+
+    if (pending == MQTT_WINDOW || 5 + remaining > MQTT_MAXPACKET) {
+        counters.dropped++;
+        return false;
+    }
+
+    Slot    &slot = window[(first + pending) % MQTT_WINDOW];
+    uint8_t *p = slot.packet;
+
+    slot.id = nextId++;
+    if (nextId == 0) {
+        nextId = 1; // 0 is not a valid packet id
+    }
+    *p++ = MQTT_PUBLISH | MQTT_QOS1;
+    p   += putLength(p, remaining);
+    p    = putString(p, topic, topicLen);
+    *p++ = slot.id >> 8;
+    *p++ = slot.id & 0xff;
+    memcpy(p, payload, len);
+    p += len;
+
+    slot.len    = p - slot.packet;
+    slot.acked  = false;
+    slot.sentAt = millis();
+    pending++;
+    counters.published++;
+
+    // offline, or with the socket backed up, it waits in the window and goes
+    // out with the resends of the next session
+    slot.sent = state == CONNECTED && send(slot.packet, slot.len);
+    return true;
+}
+
+void MqttClient::release(uint16_t id)
+{
+    for (uint8_t i = 0; i < pending; i++) {
+        Slot &slot = window[(first + i) % MQTT_WINDOW];
+        if (slot.id == id && !slot.acked) {
+            slot.acked = true;
+            counters.acked++;
+            break;
+        }
+    }
+    // acks normally arrive in order, free everything acknowledged in front
+    while (pending > 0 && window[first].acked) {
+        first = (first + 1) % MQTT_WINDOW;
+        pending--;
+    }
+}
+
+void MqttClient::handlePacket()
+{
+    switch (rxHeader & 0xf0) {
+    case MQTT_CONNACK:
+        if (state == CONNECTING && rxGot >= 2 && rx[1] == 0) {
+            state      = CONNECTED;
+            stateSince = millis();
+            retryDelay = MQTT_RETRY_MIN;
+            counters.connects++;
+            resend();
+        } else {
+            drop();
+        }
+        break;
+    case MQTT_PUBACK:
+        if (rxGot >= 2) {
+            release((rx[0] << 8) | rx[1]);
+        }
+        break;
+    case MQTT_PINGRESP:
+        pingOut = false;
+        break;
+    default:
+        // nothing else is expected, we never subscribe
+        break;
+    }
+}
+
+void MqttClient::receive()
+{
+    while (net.available() > 0) {
+        uint8_t b = net.read();
+        switch (rxStage) {
+        case RX_HEADER:
+            rxHeader = b;
+            rxLength = 0;
+            rxShift  = 0;
+            rxGot    = 0;
+            rxStage  = RX_LENGTH;
+            break;
+        case RX_LENGTH:
+            rxLength |= (uint32_t) (b & 0x7f) << rxShift;
+            rxShift  += 7;
+            if (b & 0x80) {
+                if (rxShift > 21) {
+                    drop();
+                    return;
+                }
+                break;
+            }
+            rxStage = RX_BODY;
+            if (rxLength > 0) {
+                break;
+            }
+            // fall through - a packet without a body is complete
+        case RX_BODY:
+            if (rxLength > 0) {
+                // anything past our small buffer is skipped
+                if (rxGot < MQTT_RXBUF) {
+                    rx[rxGot] = b;
+                }
+                rxGot++;
+            }
+            if (rxGot >= rxLength) {
+                rxStage = RX_HEADER;
+                handlePacket();
+                if (state == IDLE) {
+                    return;
+                }
+            }
+            break;
+        }
+    }
+}
+
+void MqttClient::loop()
+{
+    if (host == NULL || host[0] == '\0') {
+        return;
+    }
+    unsigned long now = millis();
+
+    if (state == IDLE) {
+        if ((long) (now - retryAt) >= 0) {
+            connect();
+        }
+        return;
+    }
+    if (!net.connected()) {
+        drop();
+        return;
+    }
+
+    receive();
+    if (state == IDLE) {
+        return;
+    }
+
+    if (state == CONNECTING) {
+        if (now - stateSince > MQTT_TIMEOUT) {
+            drop();
+        }
+        return;
+    }
+
+    // a PUBACK or PINGRESP that never comes means a dead link, reconnecting
+    // resends the window
+    if ((pending > 0 && !window[first].acked && now - window[first].sentAt > MQTT_TIMEOUT) ||
+        (pingOut && now - pingAt > MQTT_TIMEOUT)) {
+        drop();
+        return;
+    }
+    if (!pingOut && now - lastSend > MQTT_KEEPALIVE * 500UL) {
+        static const uint8_t ping[] = { MQTT_PINGREQ, 0 };
+        pingOut = send(ping, sizeof(ping));
+        pingAt  = now;
+    }
+}
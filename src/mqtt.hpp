@@ -0,0 +1,98 @@
+#ifndef BGE_MQTT_HPP
+#define BGE_MQTT_HPP
+
+#include <Arduino.h>
+#include <Client.h>
+
+// Minimal MQTT 3.1.1 publisher for telemetry.
+//
+// Holds a persistent session (clean session off) so the broker keeps our
+// state across reconnects, and publishes at QoS 1 with a bounded window of
+// unacknowledged messages. Every packet is built in buffers allocated up
+// front; unacknowledged ones are kept encoded and resent with the DUP flag
+// after a reconnect, as the spec asks. Nothing here waits on the socket
+// except the TCP connect itself.
+
+#define MQTT_MAXPACKET  96    // largest PUBLISH we build, topic included
+#define MQTT_WINDOW     8     // QoS 1 messages in flight
+#define MQTT_RXBUF      8     // we only expect CONNACK, PUBACK and PINGRESP
+#define MQTT_KEEPALIVE  30    // seconds
+#define MQTT_TIMEOUT    10000 // ms to wait for CONNACK or the oldest PUBACK
+#define MQTT_RETRY_MIN  1000  // ms reconnect backoff
+#define MQTT_RETRY_MAX  60000
+
+struct MqttStats {
+    uint32_t connects;
+    uint32_t published; // accepted into the window
+    uint32_t acked;
+    uint32_t resent;
+    uint32_t dropped;   // window full or socket backed up
+};
+
+class MqttClient
+{
+  public:
+    MqttClient(Client &net);
+
+    // broker address and our client id, both must outlive the client
+    void begin(const char *host, uint16_t port, const char *clientId);
+
+    // drive the connection, call often from loop()
+    void loop();
+
+    bool connected() const { return state == CONNECTED; }
+
+    // queue a QoS 1 publish, false if it was dropped
+    bool publish(const char *topic, const uint8_t *payload, size_t len);
+
+    uint8_t inFlight() const { return pending; }
+    const MqttStats &stats() const { return counters; }
+
+  private:
+    enum State { IDLE, CONNECTING, CONNECTED };
+
+    struct Slot {
+        uint16_t      id;
+        uint8_t       len;
+        bool          acked;
+        bool          sent; // went out at least once, resends carry DUP
+        unsigned long sentAt;
+        uint8_t       packet[MQTT_MAXPACKET];
+    };
+
+    void connect();
+    void drop();
+    bool send(const uint8_t *buf, size_t len);
+    void resend();
+    void receive();
+    void handlePacket();
+    void release(uint16_t id);
+
+    Client       &net;
+    const char   *host;
+    uint16_t      port;
+    const char   *clientId;
+    State         state;
+    unsigned long stateSince;
+    unsigned long lastSend;
+    unsigned long pingAt;
+    unsigned long retryAt;
+    unsigned long retryDelay;
+    bool          pingOut;
+    uint16_t      nextId;
+
+    Slot    window[MQTT_WINDOW];
+    uint8_t first, pending;
+
+    // incoming packet being parsed
+    uint8_t  rxHeader;
+    uint32_t rxLength;
+    uint8_t  rxShift;
+    uint32_t rxGot;
+    uint8_t  rxStage;
+    uint8_t  rx[MQTT_RXBUF];
+
+    MqttStats counters;
+};
+
+#endif // BGE_MQTT_HPP
@@ -0,0 +1,58 @@
+#include "mqttsink.hpp"
+
+#include <ESP8266WiFi.h>
+
+#include "bgemonitor.hpp"
+
+static WiFiClient mqttNet;
+MqttClient        mqtt(mqttNet);
+
+// one decimal, or nothing for a bad reading
+static const char *field(char *buf, size_t len, int16_t t)
+{
+    if (t == TEMP_NONE) {
+        return "";
+    }
+    fmtFixed(buf, len, t, TEMP_SHIFT, 1);
+    return buf;
+}
+
+MqttSink::MqttSink() :
+    TelemetrySink("mqtt", MQTTINTERVAL / 4, MQTTINTERVAL / CONTROLINTERVAL, MQTT_WINDOW, true), started(false)
+{
+}
+
+void MqttSink::poll()
+{
+    if (MQTTHOST[0] == '\0') {
+        return;
+    }
+    if (!started) {
+        started = true;
+        snprintf(clientId, sizeof(clientId), "bge-%06x", ESP.getChipId());
+        snprintf(topic, sizeof(topic), "bge/%06x/s", ESP.getChipId());
+        mqtt.begin(MQTTHOST, MQTTPORT, clientId);
+    }
+    mqtt.loop();
+}
+
+size_t MqttSink::consume(const TelemetrySample *samples, size_t count)
+{
+    if (MQTTHOST[0] == '\0') {
+        return count;
+    }
+
+    size_t i = 0;
+    // a full window leaves the rest in the ring until the broker catches up
+    for (; i < count && mqtt.inFlight() < MQTT_WINDOW; i++) {
+        const TelemetrySample &s = samples[i];
+        char dome[12], meat[12], fan[12], payload[80];
+        fmtDecimal(fan, sizeof(fan), (s.fan + 5) / 10, 1);
+        int  n = snprintf(payload, sizeof(payload), "%lu,%s,%s,%s,%ld,%u,%u,%u", (unsigned long) s.ms,
+                          field(dome, sizeof(dome), s.dome),
+                          field(meat, sizeof(meat), s.meat),
+                          fan, (long) roundShift(s.target, TEMP_SHIFT), s.heapFree, s.maxBlock, s.fragmentation);
+        mqtt.publish(topic, (const uint8_t *) payload, n);
+    }
+    return i;
+}
@@ -0,0 +1,33 @@
+#ifndef BGE_MQTTSINK_HPP
+#define BGE_MQTTSINK_HPP
+
+#include "mqtt.hpp"
+#include "telemetry.hpp"
+
+// Publishes samples to an MQTT broker, typically a Mosquitto on the shop
+// LAN that aggregates several controllers. Messages go to bge/<chip id>/s
+// as "millis,dome,meat,fan%,target,heap,block,frag%", an empty field for a
+// bad reading.
+
+// broker host name or address, empty leaves MQTT off
+#define MQTTHOST     ""
+#define MQTTPORT     1883
+#define MQTTINTERVAL 1000 // ms between samples
+
+extern MqttClient mqtt;
+
+class MqttSink : public TelemetrySink
+{
+  public:
+    MqttSink();
+
+    size_t consume(const TelemetrySample *samples, size_t count);
+    void   poll();
+
+  private:
+    bool started;
+    char clientId[16];
+    char topic[20];
+};
+
+#endif // BGE_MQTTSINK_HPP
@@ -0,0 +1,125 @@
+#include "netwatch.hpp"
+
+#include <ESP8266WiFi.h>
+
+#include "fastwifi.hpp"
+#include "log.hpp"
+
+NetStats netStats;
+
+static bool          linkUp = false;
+static unsigned long nextCheck = 0;
+static unsigned long downSince = 0;
+static unsigned long nextAttempt = 0;
+static unsigned long backoff = NETWATCH_BACKOFF_MIN;
+static unsigned long nextRssi = 0;
+
+static uint8_t       sendFails = 0;
+static bool          breakerOpen = false;
+static unsigned long breakerUntil = 0;
+static unsigned long cooldown = NETWATCH_COOL_MIN;
+
+static void linkDown(unsigned long now)
+{
+    linkUp      = false;
+    downSince   = now;
+    backoff     = NETWATCH_BACKOFF_MIN;
+    nextAttempt = now + backoff;
+    netStats.outages++;
+    logWarn("WiFi link lost");
+}
+
+static void linkRestored(unsigned long now)
+{
+    linkUp = true;
+    if (netStats.outages > 0) {
+        uint32_t outage = now - downSince;
+        netStats.reconnects++;
+        netStats.lastOutageMs     = outage;
+        netStats.totalOutageMs   += outage;
+        netStats.longestOutageMs  = max(netStats.longestOutageMs, outage);
+        logInfo("WiFi back after %ums", outage);
+    }
+    // the AP or lease may have changed
+    wifiCacheSave();
+}
+
+static void sampleRssi()
+{
+    int16_t sample = WiFi.RSSI();
+    if (sample >= 0) {
+        // the SDK reports 31 when it has no value
+        return;
+    }
+    // exponential average, 1/8 new
+    netStats.rssi    = netStats.rssi == 0 ? sample : netStats.rssi + (sample - netStats.rssi) / 8;
+    netStats.rssiMin = netStats.rssiMin == 0 ? netStats.rssi : min(netStats.rssiMin, netStats.rssi);
+}
+
+void netWatchLoop()
+{
+    unsigned long now = millis();
+
+    if ((long) (now - nextCheck) < 0) {
+        return;
+    }
+    nextCheck = now + NETWATCH_INTERVAL;
+
+    bool connected = WiFi.status() == WL_CONNECTED;
+    if (connected && !linkUp) {
+        linkRestored(now);
+    } else if (!connected && linkUp) {
+        linkDown(now);
+    } else if (!connected && (long) (now - nextAttempt) >= 0) {
+        // begin() only kicks off the association, the status is picked up
+        // on a later pass. Back off so a slow join is not restarted.
+        WiFi.begin();
+        netStats.attempts++;
+        backoff     = min(backoff * 2, (unsigned long) NETWATCH_BACKOFF_MAX);
+        nextAttempt = now + backoff;
+    }
+
+    if (linkUp && (long) (now - nextRssi) >= 0) {
+        nextRssi = now + NETWATCH_RSSI_PERIOD;
+        sampleRssi();
+    }
+}
+
+bool netLinkUp()
+{
+    return linkUp;
+}
+
+bool netBreakerOpen()
+{
+    return breakerOpen && (long) (millis() - breakerUntil) < 0;
+}
+
+bool netCanSend()
+{
+    // once the cooldown is over the next request is let through as a probe
+    return linkUp && !netBreakerOpen();
+}
+
+void netSendResult(bool ok)
+{
+    if (ok) {
+        sendFails   = 0;
+        breakerOpen = false;
+        cooldown    = NETWATCH_COOL_MIN;
+        return;
+    }
+
+    netStats.sendFailures++;
+    if (breakerOpen) {
+        // the probe after a cooldown failed, stay open for longer
+        cooldown     = min(cooldown * 2, (unsigned long) NETWATCH_COOL_MAX);
+        breakerUntil = millis() + cooldown;
+        netStats.breakerTrips++;
+    } else if (++sendFails >= NETWATCH_TRIP_FAILS) {
+        breakerOpen  = true;
+        breakerUntil = millis() + cooldown;
+        netStats.breakerTrips++;
+        logWarn("cloud sends failing, backing off");
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef BGE_NETWATCH_HPP
+#define BGE_NETWATCH_HPP
+
+#include <Arduino.h>
+
+// Connectivity supervisor. Watches the station link without blocking,
+// rejoins with exponential backoff when it drops, tracks signal quality and
+// runs a circuit breaker over the cloud senders, so telemetry skips at once
+// while the network is down instead of burning a connect timeout per tick.
+
+#define NETWATCH_INTERVAL    500    // ms between link checks
+#define NETWATCH_BACKOFF_MIN 2000   // ms before the first rejoin attempt
+#define NETWATCH_BACKOFF_MAX 64000  // ms between attempts at most
+#define NETWATCH_RSSI_PERIOD 5000   // ms between signal samples
+#define NETWATCH_TRIP_FAILS  3      // consecutive send failures that open the breaker
+#define NETWATCH_COOL_MIN    30000  // ms the breaker stays open at first
+#define NETWATCH_COOL_MAX    300000 // ms it stays open at most
+
+struct NetStats {
+    uint32_t outages;         // times the link went down
+    uint32_t reconnects;      // times it came back
+    uint32_t attempts;        // rejoin attempts made
+    uint32_t lastOutageMs;
+    uint32_t longestOutageMs;
+    uint32_t totalOutageMs;
+    uint32_t breakerTrips;
+    uint32_t sendFailures;
+    int16_t  rssi;            // smoothed dBm, 0 before the first sample
+    int16_t  rssiMin;         // worst smoothed value seen
+};
+
+extern NetStats netStats;
+
+// call from loop()
+void netWatchLoop();
+
+// station is associated and has an address
+bool netLinkUp();
+
+// link is up and the breaker lets a cloud request through
+bool netCanSend();
+
+// cloud senders report each request here, false for a timeout or error
+void netSendResult(bool ok);
+
+// true while the breaker holds requests back
+bool netBreakerOpen();
+
+#endif // BGE_NETWATCH_HPP
@@ -0,0 +1,161 @@
+#include "probe.hpp"
+
+#include <LittleFS.h>
+
+#include "bgemonitor.hpp"
+#include "crc32.hpp"
+#include "log.hpp"
+#include "thermocouple.hpp"
+
+static const char *const faultNames[] = { "ok", "open", "out of range", "implausible rate", "stuck" };
+
+ProbeMonitor domeProbe("dome", PROBE_STUCKTIME);
+ProbeMonitor meatProbe("meat", PROBE_MEATSTUCK);
+ProbeConfig  probeConfig;
+
+ProbeMonitor::ProbeMonitor(const char *name, unsigned long stuckMs)
+    : name(name), stuckMs(stuckMs), last(TEMP_NONE), previous(TEMP_NONE), lastMs(0), changedMs(0), faulted(PROBE_OK), bad(0), good(0),
+      seenGood(false), alertDue(false), rejects(0), trips(0)
+{
+}
+
+// 1/16 F a reading may move in ms; past a minute anything in range goes
+static long rateAllowance(unsigned long ms)
+{
+    return PROBE_MAXRATE * TEMP_SCALE * (long) min(ms, 60000UL) / 1000;
+}
+
+bool ProbeMonitor::check(int16_t reading)
+{
+    unsigned long now = millis();
+    uint8_t       why = PROBE_OK;
+
+    if (reading != previous || reading == TEMP_NONE) {
+        changedMs = now;
+    }
+    previous = reading;
+
+    if (reading == TEMP_NONE) {
+        why = PROBE_OPEN;
+    } else if (reading < PROBE_MINF * TEMP_SCALE || reading > PROBE_MAXF * TEMP_SCALE) {
+        why = PROBE_RANGE;
+    } else if (last != TEMP_NONE && abs(reading - last) > rateAllowance(now - lastMs)) {
+        why = PROBE_RATE;
+    } else if (reading > PROBE_COLDF * TEMP_SCALE && now - changedMs >= stuckMs) {
+        why = PROBE_STUCK;
+    }
+
+    if (why == PROBE_OK) {
+        last   = reading;
+        lastMs = now;
+        bad    = 0;
+        if (faulted != PROBE_OK && ++good >= PROBE_CLEAR) {
+            logInfo("%s probe ok again", name);
+            faulted = PROBE_OK;
+        }
+        seenGood = true;
+        return true;
+    }
+
+    rejects++;
+    good = 0;
+    if (faulted == PROBE_OK && ++bad >= PROBE_TRIP) {
+        faulted = why;
+        trips++;
+        logError("%s probe fault: %s", name, faultNames[why]);
+        alertDue = seenGood;
+    }
+    return false;
+}
+
+bool ProbeMonitor::takeAlert()
+{
+    if (!alertDue) {
+        return false;
+    }
+    alertDue = false;
+    return true;
+}
+
+static void save()
+{
+    probeConfig.magic = PROBE_MAGIC;
+    probeConfig.crc   = crc32Of(&probeConfig, offsetof(ProbeConfig, crc));
+
+    File f = LittleFS.open(PROBE_FILE, "w");
+    if (f) {
+        f.write((const uint8_t *) &probeConfig, sizeof(probeConfig));
+        f.close();
+    }
+}
+
+void probeBegin()
+{
+    File f = LittleFS.open(PROBE_FILE, "r");
+    bool ok = f && f.read((uint8_t *) &probeConfig, sizeof(probeConfig)) == sizeof(probeConfig) &&
+              probeConfig.magic == PROBE_MAGIC &&
+              probeConfig.crc == crc32Of(&probeConfig, offsetof(ProbeConfig, crc)) && probeConfig.safeFan <= 100;
+    if (f) {
+        f.close();
+    }
+    if (!ok) {
+        memset(&probeConfig, 0, sizeof(probeConfig));
+        probeConfig.safeFan = PROBE_SAFEFAN;
+    }
+    if (probeConfig.median == 0 || !ktc.setFilter(probeConfig.median, probeConfig.mean, probeConfig.decimate)) {
+        probeConfig.median   = KTC_MEDIAN;
+        probeConfig.mean     = KTC_MEAN;
+        probeConfig.decimate = KTC_DECIMATE;
+        ktc.setFilter(KTC_MEDIAN, KTC_MEAN, KTC_DECIMATE);
+    }
+}
+
+void probeLoop()
+{
+    ProbeMonitor *probes[] = { &domeProbe, &meatProbe };
+    char          message[64];
+
+    for (ProbeMonitor *p : probes) {
+        if (p->takeAlert()) {
+            snprintf(message, sizeof(message), "%s probe fault: %s", p->name, probeFaultName(p->fault()));
+            sendAlert(message);
+        }
+    }
+}
+
+// the filter settings are sample counts, 2.5 is a mistake rather than 2
+static bool whole(double v)
+{
+    return v == floor(v);
+}
+
+const char *probeConfigure(double safeFan, double median, double mean, double decimate)
+{
+    if (!(safeFan >= 0 && safeFan <= 100)) {
+        return "safeFan must be 0-100";
+    }
+    if (!whole(median) || !whole(mean) || !whole(decimate)) {
+        return "median, mean and decimate must be whole numbers";
+    }
+    if (!(median >= 1 && median <= KTC_MAXMEDIAN && mean >= 1 && mean <= KTC_MAXMEAN && decimate >= 1 &&
+          decimate <= KTC_RING) ||
+        !ktc.setFilter(median, mean, decimate)) {
+        return "median odd 1-7, mean 1-8, decimate 1-16";
+    }
+    probeConfig.safeFan  = lround(safeFan);
+    probeConfig.median   = median;
+    probeConfig.mean     = mean;
+    probeConfig.decimate = decimate;
+    save();
+    return NULL;
+}
+
+double probeSafeOutput()
+{
+    return probeConfig.safeFan * (double) FANWINDOW / 100;
+}
+
+const char *probeFaultName(uint8_t fault)
+{
+    return fault <= PROBE_STUCK ? faultNames[fault] : "?";
+}
@@ -0,0 +1,91 @@
+#ifndef BGE_PROBE_HPP
+#define BGE_PROBE_HPP
+
+#include <Arduino.h>
+
+// Thermocouple health. Each reading is checked as it is taken, with a few
+// integer comparisons in 1/16 F, before a controller may see it:
+//
+//   open   the MAX6675 flags an open thermocouple, read as TEMP_NONE
+//   range  outside PROBE_MINF-PROBE_MAXF, which no kamado reads
+//   rate   further from the last good reading than PROBE_MAXRATE allows
+//   stuck  the very same value for PROBE_STUCKTIME above PROBE_COLDF;
+//          a live probe in a lit grill flickers, one in a cold grill need not
+//
+// A bad reading is dropped and the last good one stands. PROBE_TRIP bad
+// readings in a row fault the probe, PROBE_CLEAR good ones clear it. While
+// the dome probe is faulted the fan runs at a safe duty instead of the
+// controller's, the fault is flagged in telemetry, and probeLoop() texts
+// an alert. A faulted meat probe holds the cascade where it is.
+
+#define PROBE_FILE      "/probe.bin"
+#define PROBE_MAGIC     0x50524231
+#define PROBE_MINF      0
+#define PROBE_MAXF      1000
+#define PROBE_MAXRATE   40     // F/s, a lid opening drops the dome slower
+#define PROBE_STUCKTIME 600000  // ms, for the dome
+#define PROBE_MEATSTUCK 3600000 // a stall holds the meat flat for a long time
+#define PROBE_COLDF     150     // F, an unlit grill or raw meat reads flat below this
+#define PROBE_TRIP      4      // bad readings in a row to fault
+#define PROBE_CLEAR     20     // good readings in a row to clear
+#define PROBE_SAFEFAN   0      // % fan while the dome probe is faulted, starves the fire
+
+enum ProbeFault { PROBE_OK, PROBE_OPEN, PROBE_RANGE, PROBE_RATE, PROBE_STUCK };
+
+class ProbeMonitor
+{
+  public:
+    ProbeMonitor(const char *name, unsigned long stuckMs);
+
+    // true when reading, in 1/16 F, is fit for the controller
+    bool check(int16_t reading);
+
+    uint8_t  fault() const { return faulted; }
+    uint32_t rejected() const { return rejects; }
+    uint32_t faults() const { return trips; }
+
+    // a fault waiting to be texted, taken once from loop()
+    bool takeAlert();
+
+    const char *name;
+
+  private:
+    unsigned long stuckMs;
+    int16_t       last;      // last good reading
+    int16_t       previous;  // last reading of any kind
+    unsigned long lastMs;    // when last was read
+    unsigned long changedMs; // when the reading last changed
+    uint8_t       faulted;   // ProbeFault
+    uint8_t       bad, good; // readings in a row
+    bool          seenGood;  // a probe never connected is not worth a text
+    volatile bool alertDue;
+    uint32_t      rejects, trips;
+};
+
+struct ProbeConfig {
+    uint32_t magic;
+    uint8_t  safeFan; // percent
+    uint8_t  median;  // dome sample filter, see thermocouple.hpp; 0 for the default
+    uint8_t  mean;
+    uint8_t  decimate;
+    uint32_t crc;
+};
+
+extern ProbeMonitor domeProbe, meatProbe;
+extern ProbeConfig  probeConfig;
+
+// load the settings and set up the dome filter
+void probeBegin();
+
+// text pending fault alerts, call from loop()
+void probeLoop();
+
+// returns an error message, or NULL once applied and saved
+const char *probeConfigure(double safeFan, double median, double mean, double decimate);
+
+// fan output in ms per window while the dome probe is faulted
+double probeSafeOutput();
+
+const char *probeFaultName(uint8_t fault);
+
+#endif // BGE_PROBE_HPP
@@ -0,0 +1,152 @@
+#include "profile.hpp"
+
+#include <LittleFS.h>
+
+#include "bgemonitor.hpp"
+#include "cookstate.hpp"
+#include "crc32.hpp"
+#include "log.hpp"
+
+Profile         profile;
+ProfileProgress profileProgress;
+
+static unsigned long nextUpdate = 0;
+
+template <typename T>
+static bool load(const char *path, T &data, uint32_t magic)
+{
+    File f  = LittleFS.open(path, "r");
+    bool ok = f && f.read((uint8_t *) &data, sizeof(data)) == sizeof(data) && data.magic == magic &&
+              data.crc == crc32Of(&data, offsetof(T, crc));
+    if (f) {
+        f.close();
+    }
+    return ok;
+}
+
+template <typename T>
+static void store(const char *path, T &data, uint32_t magic)
+{
+    data.magic = magic;
+    data.crc   = crc32Of(&data, offsetof(T, crc));
+
+    File f = LittleFS.open(path, "w");
+    if (f) {
+        f.write((const uint8_t *) &data, sizeof(data));
+        f.close();
+    }
+}
+
+static void beginStep(uint8_t step)
+{
+    profileProgress.step          = step;
+    profileProgress.stepStart     = cookSeconds();
+    profileProgress.startSetpoint = domeTarget;
+    if (step >= profile.count) {
+        profileProgress.running = false;
+        logInfo("profile finished");
+        sendAlert("BGE cook profile finished");
+    }
+    store(PROFILE_PROGRESS, profileProgress, PROFILE_MAGIC);
+}
+
+void profileBegin()
+{
+    if (!load(PROFILE_FILE, profile, PROFILE_MAGIC)) {
+        memset(&profile, 0, sizeof(profile));
+    }
+    if (!load(PROFILE_PROGRESS, profileProgress, PROFILE_MAGIC) || profileProgress.step >= profile.count) {
+        memset(&profileProgress, 0, sizeof(profileProgress));
+    }
+    if (profileProgress.running) {
+        logInfo("profile resumed at step %u, %us in", profileProgress.step + 1,
+                cookSeconds() - profileProgress.stepStart);
+    }
+}
+
+void profileLoop()
+{
+    if (!profileProgress.running || (long) (millis() - nextUpdate) < 0) {
+        return;
+    }
+    nextUpdate = millis() + PROFILE_INTERVAL;
+
+    const ProfileStep &step    = profile.steps[profileProgress.step];
+    uint32_t           elapsed = cookSeconds() - profileProgress.stepStart;
+    bool               done    = false;
+
+    switch (step.type) {
+    case PROFILE_RAMP: {
+        uint32_t duration = step.arg * 60UL;
+        if (elapsed >= duration) {
+            domeTarget = step.dome;
+            done       = true;
+        } else {
+            domeTarget = profileProgress.startSetpoint + (step.dome - profileProgress.startSetpoint) * elapsed / duration;
+        }
+        break;
+    }
+    case PROFILE_HOLD:
+        domeTarget = step.dome;
+        done       = elapsed >= step.arg * 60UL;
+        break;
+    case PROFILE_UNTIL:
+        domeTarget = step.dome;
+        done       = !isnan(meatTempF) && meatTempF >= step.arg;
+        break;
+    default:
+        done = true;
+    }
+
+    // one step per tick at most, the next one starts on the next tick
+    if (done) {
+        logInfo("profile step %u done", profileProgress.step + 1);
+        beginStep(profileProgress.step + 1);
+    }
+}
+
+bool profileRunning()
+{
+    return profileProgress.running;
+}
+
+bool profileStore(const ProfileStep *steps, uint8_t count)
+{
+    if (count == 0 || count > PROFILE_MAXSTEPS) {
+        return false;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        const ProfileStep &s = steps[i];
+        if (s.type < PROFILE_RAMP || s.type > PROFILE_UNTIL || s.dome < DOMEMIN || s.dome > DOMEMAX) {
+            return false;
+        }
+        if (s.type == PROFILE_UNTIL && !(s.arg >= 32 && s.arg < s.dome)) {
+            return false;
+        }
+    }
+
+    profileStop();
+    memset(&profile, 0, sizeof(profile));
+    memcpy(profile.steps, steps, count * sizeof(ProfileStep));
+    profile.count = count;
+    store(PROFILE_FILE, profile, PROFILE_MAGIC);
+    return true;
+}
+
+void profileStart()
+{
+    if (profile.count == 0) {
+        return;
+    }
+    profileProgress.running = true;
+    beginStep(0);
+    logInfo("profile started, %u steps", profile.count);
+}
+
+void profileStop()
+{
+    if (profileProgress.running) {
+        profileProgress.running = false;
+        store(PROFILE_PROGRESS, profileProgress, PROFILE_MAGIC);
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef BGE_PROFILE_HPP
+#define BGE_PROFILE_HPP
+
+#include <Arduino.h>
+
+// Cook profiles: a short program of ramp and hold steps that drives
+// domeTarget through a cook, e.g. smoke at 225 for four hours, ramp to 275
+// over an hour, then hold until the meat reads 160.
+//
+// Each tick only looks at the current step, with the step's start time and
+// starting setpoint kept, so evaluation is constant time however long the
+// profile. The program and the progress through it are stored in flash,
+// the latter on every step change; time within a step is measured on the
+// cook clock, which carries across resets, so a reset resumes mid-step.
+
+#define PROFILE_FILE     "/profile.bin"
+#define PROFILE_PROGRESS "/profile.run"
+#define PROFILE_MAXSTEPS 16
+#define PROFILE_INTERVAL 1000 // ms between evaluations
+#define PROFILE_MAGIC    0x50524631
+
+enum ProfileStepType {
+    PROFILE_RAMP = 1, // move the setpoint linearly to dome over arg minutes
+    PROFILE_HOLD,     // hold dome for arg minutes
+    PROFILE_UNTIL     // hold dome until the meat reaches arg F
+};
+
+struct ProfileStep {
+    uint8_t  type;
+    uint8_t  reserved;
+    int16_t  dome;
+    uint16_t arg;
+};
+
+struct Profile {
+    uint32_t    magic;
+    uint8_t     count;
+    uint8_t     reserved[3];
+    ProfileStep steps[PROFILE_MAXSTEPS];
+    uint32_t    crc;
+};
+
+struct ProfileProgress {
+    uint32_t magic;
+    uint8_t  running;
+    uint8_t  step;
+    uint16_t reserved;
+    uint32_t stepStart;     // cook seconds when the step began
+    float    startSetpoint; // domeTarget when the step began
+    uint32_t crc;
+};
+
+extern Profile         profile;
+extern ProfileProgress profileProgress;
+
+// load the program and progress, call after cookStateBegin()
+void profileBegin();
+
+// advance the running profile when due, call from loop()
+void profileLoop();
+
+bool profileRunning();
+
+// replace the program, stopping any run in progress; false if the steps
+// do not make sense
+bool profileStore(const ProfileStep *steps, uint8_t count);
+
+// start from the first step, or stop where it is
+void profileStart();
+void profileStop();
+
+#endif // BGE_PROFILE_HPP
@@ -0,0 +1,830 @@
+#include "restapi.hpp"
+
+#include "bench.hpp"
+#include "bgemonitor.hpp"
+#include "cascade.hpp"
+#include "cookstate.hpp"
+#include "dashboard.hpp"
+#include "fastwifi.hpp"
+#include "fixed.hpp"
+#include "health.hpp"
+#include "jsonstream.hpp"
+#include "log.hpp"
+#include "model.hpp"
+#include "mpc.hpp"
+#include "mqttsink.hpp"
+#include "netwatch.hpp"
+#include "probe.hpp"
+#include "profile.hpp"
+#include "telemetry.hpp"
+#include "thermocouple.hpp"
+
+// the fields we accept in request bodies, NAN or -1 when absent
+struct ApiRequest {
+    double target;
+    double kp, ki, kd;
+    double fan;
+    double rate;
+    int    mode;
+    bool   badMode;
+    bool   newCook;
+    int    level;
+    bool   badLevel;
+    int    enabled;
+    double meat, domeMin, domeMax;
+    int    mpc;
+    double safeFan;
+    double median, mean, decimate;
+};
+
+static void collectField(void *ctx, const JsonStream &json, JsonStream::Event event)
+{
+    ApiRequest *req = (ApiRequest *) ctx;
+
+    if (event != JsonStream::VALUE || json.depth() != 1) {
+        return;
+    }
+    if (json.isKey("target")) {
+        req->target = json.number();
+    } else if (json.isKey("kp")) {
+        req->kp = json.number();
+    } else if (json.isKey("ki")) {
+        req->ki = json.number();
+    } else if (json.isKey("kd")) {
+        req->kd = json.number();
+    } else if (json.isKey("fan")) {
+        req->fan = json.number();
+    } else if (json.isKey("rate")) {
+        req->rate = json.number();
+    } else if (json.isKey("new")) {
+        req->newCook = json.type() == JsonStream::BOOLEAN && json.boolean();
+    } else if (json.isKey("enabled")) {
+        req->enabled = json.type() == JsonStream::BOOLEAN ? json.boolean() : -2;
+    } else if (json.isKey("mpc")) {
+        req->mpc = json.type() == JsonStream::BOOLEAN ? json.boolean() : -2;
+    } else if (json.isKey("safeFan")) {
+        req->safeFan = json.number();
+    } else if (json.isKey("median")) {
+        req->median = json.number();
+    } else if (json.isKey("mean")) {
+        req->mean = json.number();
+    } else if (json.isKey("decimate")) {
+        req->decimate = json.number();
+    } else if (json.isKey("meat")) {
+        req->meat = json.number();
+    } else if (json.isKey("domeMin")) {
+        req->domeMin = json.number();
+    } else if (json.isKey("domeMax")) {
+        req->domeMax = json.number();
+    } else if (json.isKey("level")) {
+        LogLevel level;
+        if (logLevelParse(json.text(), level)) {
+            req->level = level;
+        } else {
+            req->badLevel = true;
+        }
+    } else if (json.isKey("mode")) {
+        if (strcasecmp(json.text(), "AUTOMATIC") == 0) {
+            req->mode = AUTOMATIC;
+        } else if (strcasecmp(json.text(), "MANUAL") == 0) {
+            req->mode = MANUAL;
+        } else {
+            req->badMode = true;
+        }
+    }
+}
+
+// runs the request body through the streaming parser into req
+static bool parseBody(ApiRequest &req)
+{
+    req.target = req.kp = req.ki = req.kd = req.fan = req.rate = NAN;
+    req.mode     = -1;
+    req.badMode  = false;
+    req.newCook  = false;
+    req.level    = -1;
+    req.badLevel = false;
+    req.enabled  = -1;
+    req.mpc      = -1;
+    req.meat = req.domeMin = req.domeMax = NAN;
+    req.safeFan = req.median = req.mean = req.decimate = NAN;
+
+    JsonStream json(collectField, &req);
+    String     body = webServer.arg("plain");
+    return json.feed(body.c_str(), body.length()) && json.finish();
+}
+
+static void sendError(int code, const char *message)
+{
+    char reply[80];
+    snprintf(reply, sizeof(reply), "{\"error\":\"%s\"}", message);
+    webServer.send(code, "application/json", reply);
+}
+
+static void sendStatus()
+{
+    char dome[12], meat[12], fan[12], target[12], kp[12], ki[12], kd[12], rate[12];
+    char reply[280];
+
+    snprintf(reply, sizeof(reply),
+             "{\"dome\":%s,\"meat\":%s,\"fan\":%s,\"target\":%s,\"mode\":\"%s\",\"kp\":%s,\"ki\":%s,\"kd\":%s,"
+             "\"rate\":%s,\"cook\":%u,\"wifiMs\":%lu,\"wifiFast\":%s}",
+             jsonTemp(dome, sizeof(dome), domeTemp, 1),
+             jsonTemp(meat, sizeof(meat), meatTemp, 1),
+             jsonNumber(fan, sizeof(fan), fanOutput * 100.0 / FANWINDOW, 1),
+             jsonNumber(target, sizeof(target), domeTarget, 1),
+             domePID.GetMode() == AUTOMATIC ? "AUTOMATIC" : "MANUAL",
+             jsonNumber(kp, sizeof(kp), domePID.GetKp(), 3),
+             jsonNumber(ki, sizeof(ki), domePID.GetKi(), 3),
+             jsonNumber(kd, sizeof(kd), domePID.GetKd(), 3),
+             jsonNumber(rate, sizeof(rate), domePID.GetOutputRate() * 100.0 / FANWINDOW, 2),
+             cookSeconds(), wifiConnectMs, wifiConnectFast ? "true" : "false");
+    webServer.send(200, "application/json", reply);
+}
+
+static void handleStatus()
+{
+    sendStatus();
+}
+
+static void handleSetpoint()
+{
+    ApiRequest req;
+
+    if (!parseBody(req)) {
+        sendError(400, "malformed JSON");
+        return;
+    }
+    if (!(req.target >= DOMEMIN && req.target <= DOMEMAX)) {
+        sendError(400, "target out of range");
+        return;
+    }
+    if (cascade.enabled) {
+        sendError(409, "dome target is set by the cascade");
+        return;
+    }
+    if (profileRunning()) {
+        sendError(409, "dome target is set by the cook profile");
+        return;
+    }
+    domeTarget = req.target;
+    cookStateSave();
+    sendStatus();
+}
+
+static void handleTunings()
+{
+    ApiRequest req;
+
+    if (!parseBody(req)) {
+        sendError(400, "malformed JSON");
+        return;
+    }
+    // absent gains keep their current value
+    double kp = isnan(req.kp) ? domePID.GetKp() : req.kp;
+    double ki = isnan(req.ki) ? domePID.GetKi() : req.ki;
+    double kd = isnan(req.kd) ? domePID.GetKd() : req.kd;
+    if (!(kp >= 0 && kp <= GAINMAX && ki >= 0 && ki <= GAINMAX && kd >= 0 && kd <= GAINMAX)) {
+        sendError(400, "gains must be 0-1000");
+        return;
+    }
+    if (!isnan(req.rate) && !(req.rate >= 0 && req.rate <= 100)) {
+        sendError(400, "rate must be 0-100 %/s");
+        return;
+    }
+    // the integral term is kept as output, so new gains take effect
+    // without a jump in fanOutput
+    domePID.SetTunings(kp, ki, kd);
+    if (!isnan(req.rate)) {
+        domePID.SetOutputRate(req.rate * FANWINDOW / 100.0);
+    }
+    sendStatus();
+}
+
+static void handleMode()
+{
+    ApiRequest req;
+
+    if (!parseBody(req)) {
+        sendError(400, "malformed JSON");
+        return;
+    }
+    if (req.badMode || req.mode < 0) {
+        sendError(400, "mode must be AUTOMATIC or MANUAL");
+        return;
+    }
+    if (!isnan(req.fan) && !(req.fan >= 0 && req.fan <= 100)) {
+        sendError(400, "fan must be 0-100");
+        return;
+    }
+
+    if (req.mode == MANUAL) {
+        domePID.SetMode(MANUAL);
+        if (!isnan(req.fan)) {
+            fanOutput = req.fan * FANWINDOW / 100.0;
+        }
+    } else {
+        // switching to AUTOMATIC seeds the integrator from the current
+        // fanOutput, so the hand-off from manual is bumpless
+        domeAutomatic();
+    }
+    cookStateSave();
+    sendStatus();
+}
+
+static void handleNet()
+{
+    char reply[400];
+    const MqttStats &m = mqtt.stats();
+
+    snprintf(reply, sizeof(reply),
+             "{\"rssi\":%d,\"rssiMin\":%d,\"outages\":%u,\"reconnects\":%u,\"attempts\":%u,"
+             "\"lastOutageMs\":%u,\"longestOutageMs\":%u,\"totalOutageMs\":%u,"
+             "\"sendFailures\":%u,\"breakerTrips\":%u,\"breakerOpen\":%s,"
+             "\"mqtt\":{\"connected\":%s,\"connects\":%u,\"published\":%u,\"acked\":%u,"
+             "\"resent\":%u,\"dropped\":%u,\"inFlight\":%u}}",
+             netStats.rssi, netStats.rssiMin, netStats.outages, netStats.reconnects, netStats.attempts,
+             netStats.lastOutageMs, netStats.longestOutageMs, netStats.totalOutageMs,
+             netStats.sendFailures, netStats.breakerTrips, netBreakerOpen() ? "true" : "false",
+             mqtt.connected() ? "true" : "false", m.connects, m.published, m.acked, m.resent, m.dropped,
+             mqtt.inFlight());
+    webServer.send(200, "application/json", reply);
+}
+
+// the longest telemetry reply, every counter at ten digits
+#define TELEMETRY_REPLY (35 + TELEMETRY_MAXSINKS * (78 + TELEMETRY_NAMEMAX))
+
+static void handleTelemetry()
+{
+    char     reply[TELEMETRY_REPLY];
+    uint32_t produced = telemetryProduced();
+    size_t   n        = snprintf(reply, sizeof(reply), "{\"produced\":%u,\"sinks\":[", produced);
+
+    for (uint8_t i = 0; i < telemetrySinkCount() && n < sizeof(reply); i++) {
+        const TelemetrySink *sink = telemetrySink(i);
+        n += snprintf(reply + n, sizeof(reply) - n,
+                      "%s{\"name\":\"%s\",\"delivered\":%u,\"overruns\":%u,\"pending\":%u}",
+                      i > 0 ? "," : "", sink->name, sink->delivered, sink->overruns, produced - sink->cursor);
+    }
+    if (n < sizeof(reply)) {
+        n += snprintf(reply + n, sizeof(reply) - n, "]}");
+    }
+    if (n >= sizeof(reply)) {
+        sendError(500, "reply too long");
+        return;
+    }
+    webServer.send(200, "application/json", reply);
+}
+
+static void handleHealth()
+{
+    char reply[320];
+
+    snprintf(reply, sizeof(reply),
+             "{\"heap\":%u,\"heapMin\":%u,\"block\":%u,\"blockMin\":%u,\"frag\":%u,\"stackFree\":%u,"
+             "\"blockTrend\":%d,\"alert\":\"%s\",\"uptime\":%lu,\"reset\":\"%s\",\"excCause\":%u,"
+             "\"excAddress\":%u}",
+             health.heapFree, health.heapFreeMin, health.maxBlock, health.maxBlockMin, health.fragmentation,
+             health.stackFree, health.blockTrend, healthAlertName(health.alert), millis() / 1000,
+             healthResetName(health.resetReason), health.excCause, health.excAddress);
+    webServer.send(200, "application/json", reply);
+}
+
+static void sendCascade()
+{
+    char meat[12], lo[12], hi[12], meatNow[12], target[12];
+    char reply[160];
+
+    snprintf(reply, sizeof(reply),
+             "{\"enabled\":%s,\"meat\":%s,\"domeMin\":%s,\"domeMax\":%s,\"meatF\":%s,\"target\":%s}",
+             cascade.enabled ? "true" : "false",
+             jsonNumber(meat, sizeof(meat), cascade.meatTarget, 1),
+             jsonNumber(lo, sizeof(lo), cascade.domeMin, 1),
+             jsonNumber(hi, sizeof(hi), cascade.domeMax, 1),
+             jsonTemp(meatNow, sizeof(meatNow), meatTemp, 1),
+             jsonNumber(target, sizeof(target), domeTarget, 1));
+    webServer.send(200, "application/json", reply);
+}
+
+static void handleCascadeGet()
+{
+    sendCascade();
+}
+
+static void handleCascadePut()
+{
+    ApiRequest req;
+
+    if (!parseBody(req)) {
+        sendError(400, "malformed JSON");
+        return;
+    }
+    if (req.enabled == -2) {
+        sendError(400, "enabled must be true or false");
+        return;
+    }
+    if (req.enabled == 1 && profileRunning()) {
+        sendError(409, "stop the cook profile first");
+        return;
+    }
+    // anything left out keeps its current value
+    const char *error = cascadeConfigure(req.enabled >= 0 ? req.enabled : cascade.enabled,
+                                         isnan(req.meat) ? cascade.meatTarget : req.meat,
+                                         isnan(req.domeMin) ? cascade.domeMin : req.domeMin,
+                                         isnan(req.domeMax) ? cascade.domeMax : req.domeMax);
+    if (error != NULL) {
+        sendError(400, error);
+        return;
+    }
+    cookStateSave();
+    sendCascade();
+}
+
+static void sendModel()
+{
+    char gain[12], tau[12], ambient[12], ff[12];
+    char reply[200];
+
+    snprintf(reply, sizeof(reply),
+             "{\"enabled\":%s,\"mpc\":%s,\"trusted\":%s,\"samples\":%u,\"gain\":%s,\"tau\":%s,\"ambient\":%s,"
+             "\"ff\":%s,\"mpcUs\":%lu}",
+             feedForwardEnabled ? "true" : "false",
+             mpcEnabled ? "true" : "false",
+             domeModel.trusted() ? "true" : "false",
+             domeModel.samples(),
+             jsonNumber(gain, sizeof(gain), domeModel.gain(), 1),
+             jsonNumber(tau, sizeof(tau), domeModel.timeConstant(), 0),
+             jsonNumber(ambient, sizeof(ambient), domeModel.ambient(), 1),
+             jsonNumber(ff, sizeof(ff), feedForwardOutput() * 100.0 / FANWINDOW, 1),
+             domeMpc.solveMicros());
+    webServer.send(200, "application/json", reply);
+}
+
+static void handleModelGet()
+{
+    sendModel();
+}
+
+static void handleModelPut()
+{
+    ApiRequest req;
+
+    if (!parseBody(req)) {
+        sendError(400, "malformed JSON");
+        return;
+    }
+    if (req.enabled == -2) {
+        sendError(400, "enabled must be true or false");
+        return;
+    }
+    if (req.mpc == -2) {
+        sendError(400, "mpc must be true or false");
+        return;
+    }
+    if (req.enabled >= 0) {
+        feedForwardEnabled = req.enabled;
+    }
+    if (req.mpc >= 0) {
+        mpcEnabled = req.mpc;
+    }
+    sendModel();
+}
+
+static void sendProbe()
+{
+    char  readUs[12], filterUs[12];
+    char  reply[280];
+    float mhz = ESP.getCpuFreqMHz();
+
+    snprintf(reply, sizeof(reply),
+             "{\"safeFan\":%u,\"median\":%u,\"mean\":%u,\"decimate\":%u,\"readUs\":%s,\"filterUs\":%s,"
+             "\"dome\":{\"fault\":\"%s\",\"rejected\":%u,\"faults\":%u},"
+             "\"meat\":{\"fault\":\"%s\",\"rejected\":%u,\"faults\":%u}}",
+             probeConfig.safeFan, probeConfig.median, probeConfig.mean, probeConfig.decimate,
+             jsonNumber(readUs, sizeof(readUs), ktc.readCycles() / mhz, 1),
+             jsonNumber(filterUs, sizeof(filterUs), ktc.filterCycles() / mhz, 2),
+             probeFaultName(domeProbe.fault()), domeProbe.rejected(), domeProbe.faults(),
+             probeFaultName(meatProbe.fault()), meatProbe.rejected(), meatProbe.faults());
+    webServer.send(200, "application/json", reply);
+}
+
+static void handleProbeGet()
+{
+    sendProbe();
+}
+
+static void handleProbePut()
+{
+    ApiRequest req;
+
+    if (!parseBody(req)) {
+        sendError(400, "malformed JSON");
+        return;
+    }
+    // anything left out keeps its current value
+    const char *error = probeConfigure(isnan(req.safeFan) ? probeConfig.safeFan : req.safeFan,
+                                       isnan(req.median) ? probeConfig.median : req.median,
+                                       isnan(req.mean) ? probeConfig.mean : req.mean,
+                                       isnan(req.decimate) ? probeConfig.decimate : req.decimate);
+    if (error != NULL) {
+        sendError(400, error);
+        return;
+    }
+    sendProbe();
+}
+
+// the longest bench reply, every count at ten digits
+#define BENCH_REPLY (31 + BENCH_CASES * (14 + BENCH_NAMEMAX))
+
+static void handleBench()
+{
+    BenchResult results[BENCH_CASES];
+    char        reply[BENCH_REPLY];
+    uint8_t     count = benchRun(results);
+    size_t      n     = snprintf(reply, sizeof(reply), "{\"mhz\":%u,\"cycles\":{", ESP.getCpuFreqMHz());
+
+    for (uint8_t i = 0; i < count && n < sizeof(reply); i++) {
+        n += snprintf(reply + n, sizeof(reply) - n, "%s\"%s\":%u", i > 0 ? "," : "", results[i].name,
+                      results[i].cycles);
+    }
+    if (n < sizeof(reply)) {
+        n += snprintf(reply + n, sizeof(reply) - n, "}}");
+    }
+    if (n >= sizeof(reply)) {
+        sendError(500, "reply too long");
+        return;
+    }
+    webServer.send(200, "application/json", reply);
+}
+
+// a calibration upload, {"dome":[{"read":33.4,"actual":32},{"read":208,"actual":212}],"meat":[]}
+struct CalibrationRequest {
+    CalPoint points[CAL_PROBES][CAL_MAXPOINTS];
+    uint8_t  count[CAL_PROBES];
+    bool     have[CAL_PROBES];
+    bool     bad;
+    int      probe; // the array being read, -1 for none
+    double   read, actual;
+};
+
+static const char *const calProbeNames[CAL_PROBES] = { "dome", "meat" };
+
+static void collectCalibration(void *ctx, const JsonStream &json, JsonStream::Event event)
+{
+    CalibrationRequest *req = (CalibrationRequest *) ctx;
+
+    if (event == JsonStream::ARRAY_BEGIN && json.depth() == 1) {
+        req->probe = -1;
+        for (uint8_t p = 0; p < CAL_PROBES; p++) {
+            if (json.isKey(calProbeNames[p])) {
+                req->probe   = p;
+                req->have[p] = true;
+            }
+        }
+    } else if (req->probe < 0) {
+        return;
+    } else if (event == JsonStream::OBJECT_BEGIN && json.depth() == 2) {
+        req->read = req->actual = NAN;
+    } else if (event == JsonStream::OBJECT_END && json.depth() == 2) {
+        uint8_t &n = req->count[req->probe];
+        if (!(fabs(req->read) <= DOMEMAX * 2 && fabs(req->actual) <= DOMEMAX * 2)) {
+            req->bad = true;
+        } else if (n < CAL_MAXPOINTS) {
+            req->points[req->probe][n].read   = lround(req->read * TEMP_SCALE);
+            req->points[req->probe][n].actual = lround(req->actual * TEMP_SCALE);
+        }
+        n = min(n + 1, CAL_MAXPOINTS + 1);
+    } else if (event == JsonStream::VALUE && json.depth() == 3) {
+        if (json.isKey("read")) {
+            req->read = json.number();
+        } else if (json.isKey("actual")) {
+            req->actual = json.number();
+        }
+    }
+}
+
+static void sendCalibration()
+{
+    char   read[12], actual[12];
+    char   reply[512];
+    size_t n = snprintf(reply, sizeof(reply), "{");
+
+    for (uint8_t p = 0; p < CAL_PROBES && n < sizeof(reply); p++) {
+        n += snprintf(reply + n, sizeof(reply) - n, "%s\"%s\":[", p > 0 ? "," : "", calProbeNames[p]);
+        for (uint8_t i = 0; i < calConfig.count[p] && n < sizeof(reply); i++) {
+            const CalPoint &c = calConfig.points[p][i];
+            n += snprintf(reply + n, sizeof(reply) - n, "%s{\"read\":%s,\"actual\":%s}", i > 0 ? "," : "",
+                          jsonTemp(read, sizeof(read), c.read, 2),
+                          jsonTemp(actual, sizeof(actual), c.actual, 2));
+        }
+        if (n < sizeof(reply)) {
+            n += snprintf(reply + n, sizeof(reply) - n, "]");
+        }
+    }
+    if (n < sizeof(reply)) {
+        snprintf(reply + n, sizeof(reply) - n, "}");
+    }
+    webServer.send(200, "application/json", reply);
+}
+
+static void handleCalibrationGet()
+{
+    sendCalibration();
+}
+
+static void handleCalibrationPut()
+{
+    CalibrationRequest req;
+
+    memset(&req, 0, sizeof(req));
+    req.probe = -1;
+    JsonStream json(collectCalibration, &req);
+    String     body = webServer.arg("plain");
+    if (!json.feed(body.c_str(), body.length()) || !json.finish()) {
+        sendError(400, "malformed JSON");
+        return;
+    }
+    if (req.bad) {
+        sendError(400, "points need read and actual in F");
+        return;
+    }
+    for (uint8_t p = 0; p < CAL_PROBES; p++) {
+        if (!req.have[p]) {
+            continue;
+        }
+        const char *error = calibrationConfigure(p, req.points[p], req.count[p]);
+        if (error != NULL) {
+            sendError(400, error);
+            return;
+        }
+    }
+    sendCalibration();
+}
+
+// a profile upload, {"steps":[{"ramp":275,"minutes":60},{"hold":225,"meat":160}],"run":true}
+struct ProfileRequest {
+    ProfileStep steps[PROFILE_MAXSTEPS];
+    uint8_t     count;
+    bool        haveSteps;
+    bool        bad;
+    int         run;
+    // the step being read
+    ProfileStep step;
+    int         minutes, meat;
+};
+
+static void collectProfile(void *ctx, const JsonStream &json, JsonStream::Event event)
+{
+    ProfileRequest *req = (ProfileRequest *) ctx;
+
+    if (event == JsonStream::ARRAY_BEGIN && json.depth() == 1 && json.isKey("steps")) {
+        req->haveSteps = true;
+    } else if (event == JsonStream::OBJECT_BEGIN && json.depth() == 2) {
+        memset(&req->step, 0, sizeof(req->step));
+        req->minutes = req->meat = -1;
+    } else if (event == JsonStream::OBJECT_END && json.depth() == 2) {
+        ProfileStep &s = req->step;
+        if (req->minutes == -2 || req->meat == -2) {
+            req->bad = true;
+        } else if (s.type == PROFILE_HOLD && req->meat >= 0 && req->minutes < 0) {
+            s.type = PROFILE_UNTIL;
+            s.arg  = req->meat;
+        } else if (s.type != 0 && req->minutes >= 0 && req->meat < 0) {
+            s.arg = req->minutes;
+        } else {
+            req->bad = true;
+        }
+        if (req->count < PROFILE_MAXSTEPS) {
+            req->steps[req->count] = s;
+        }
+        req->count++;
+    } else if (event == JsonStream::VALUE && json.depth() == 3) {
+        double v = json.number();
+        if (json.isKey("ramp") || json.isKey("hold")) {
+            req->step.type = json.isKey("ramp") ? PROFILE_RAMP : PROFILE_HOLD;
+            req->step.dome = v >= DOMEMIN && v <= DOMEMAX ? (int16_t) v : 0;
+        } else if (json.isKey("minutes")) {
+            req->minutes = v >= 0 && v <= UINT16_MAX ? (int) v : -2;
+        } else if (json.isKey("meat")) {
+            req->meat = v >= 0 && v <= DOMEMAX ? (int) v : -2;
+        }
+    } else if (event == JsonStream::VALUE && json.depth() == 1 && json.isKey("run")) {
+        req->run = json.type() == JsonStream::BOOLEAN ? json.boolean() : -2;
+    }
+}
+
+static void sendProfile()
+{
+    // the header, then up to 32 bytes a step: ,{"ramp":-32768,"minutes":65535}
+    char   reply[64 + PROFILE_MAXSTEPS * 32];
+    size_t n = snprintf(reply, sizeof(reply), "{\"running\":%s,\"step\":%u,\"elapsed\":%u,\"steps\":[",
+                        profileRunning() ? "true" : "false", profileProgress.step,
+                        profileRunning() ? cookSeconds() - profileProgress.stepStart : 0);
+
+    for (uint8_t i = 0; i < profile.count && n < sizeof(reply); i++) {
+        const ProfileStep &s = profile.steps[i];
+        n += snprintf(reply + n, sizeof(reply) - n, "%s{\"%s\":%d,\"%s\":%u}", i > 0 ? "," : "",
+                      s.type == PROFILE_RAMP ? "ramp" : "hold", s.dome,
+                      s.type == PROFILE_UNTIL ? "meat" : "minutes", s.arg);
+    }
+    if (n < sizeof(reply)) {
+        snprintf(reply + n, sizeof(reply) - n, "]}");
+    }
+    webServer.send(200, "application/json", reply);
+}
+
+static void handleProfileGet()
+{
+    sendProfile();
+}
+
+static void handleProfilePut()
+{
+    ProfileRequest req;
+    memset(&req, 0, sizeof(req));
+    req.run = -1;
+
+    JsonStream json(collectProfile, &req);
+    String     body = webServer.arg("plain");
+    if (!json.feed(body.c_str(), body.length()) || !json.finish()) {
+        sendError(400, "malformed JSON");
+        return;
+    }
+    if (req.run == -2) {
+        sendError(400, "run must be true or false");
+        return;
+    }
+    if (req.haveSteps) {
+        if (req.bad || req.count > PROFILE_MAXSTEPS || !profileStore(req.steps, req.count)) {
+            sendError(400, "steps need ramp or hold with minutes, or hold with meat");
+            return;
+        }
+    }
+    if (req.run == 1) {
+        if (cascade.enabled) {
+            sendError(409, "turn the cascade off first");
+            return;
+        }
+        if (profile.count == 0) {
+            sendError(409, "no profile stored");
+            return;
+        }
+        profileStart();
+    } else if (req.run == 0) {
+        profileStop();
+    }
+    sendProfile();
+}
+
+static void sendLog()
+{
+    char            reply[120];
+    const LogStats &s = logStats();
+
+    snprintf(reply, sizeof(reply), "{\"level\":\"%s\",\"written\":%u,\"dropped\":%u,\"queued\":%u}",
+             logLevelName(logLevel), s.written, s.dropped, s.queued);
+    webServer.send(200, "application/json", reply);
+}
+
+static void handleLogGet()
+{
+    sendLog();
+}
+
+static void handleLogPut()
+{
+    ApiRequest req;
+
+    if (!parseBody(req)) {
+        sendError(400, "malformed JSON");
+        return;
+    }
+    if (req.badLevel || req.level < 0) {
+        sendError(400, "level must be error, warn, info or debug");
+        return;
+    }
+    logLevel = (LogLevel) req.level;
+    sendLog();
+}
+
+static void handleCook()
+{
+    ApiRequest req;
+
+    if (!parseBody(req)) {
+        sendError(400, "malformed JSON");
+        return;
+    }
+    if (!req.newCook) {
+        sendError(400, "nothing to do, send new: true");
+        return;
+    }
+    cookStateNew();
+    sendStatus();
+}
+
+// streams history points out in chunks of a fixed buffer
+struct HistoryWriter {
+    char   buf[512];
+    size_t len;
+    bool   first;
+};
+
+static void flushHistory(HistoryWriter &out)
+{
+    if (out.len > 0) {
+        webServer.sendContent_P(out.buf, out.len);
+        out.len = 0;
+    }
+}
+
+// quantized temperature as F with one decimal, or null
+static const char *historyTemp(char *buf, size_t len, int16_t v, bool valid)
+{
+    if (!valid) {
+        return "null";
+    }
+    fmtDecimal(buf, len, (int32_t) v * 10 / HISTORY_TEMP_SCALE, 1);
+    return buf;
+}
+
+static bool writeHistoryPoint(void *ctx, const HistoryPoint &point)
+{
+    HistoryWriter &out = *(HistoryWriter *) ctx;
+    char dome[10], meat[10], lo[10], hi[10], fan[8];
+    bool hasDome = point.valid & (1 << HISTORY_DOME);
+
+    if (point.valid & (1 << HISTORY_FAN)) {
+        fmtDecimal(fan, sizeof(fan), point.value[HISTORY_FAN], 0);
+    } else {
+        strcpy(fan, "null");
+    }
+
+    char line[80];
+    int  n = snprintf(line, sizeof(line), "%s[%u,%s,%s,%s,%s,%s]", out.first ? "" : ",",
+                      (unsigned) point.time,
+                      historyTemp(dome, sizeof(dome), point.value[HISTORY_DOME], hasDome),
+                      historyTemp(meat, sizeof(meat), point.value[HISTORY_MEAT], point.valid & (1 << HISTORY_MEAT)),
+                      fan,
+                      historyTemp(lo, sizeof(lo), point.domeMin, hasDome),
+                      historyTemp(hi, sizeof(hi), point.domeMax, hasDome));
+    if (out.len + n > sizeof(out.buf)) {
+        flushHistory(out);
+    }
+    memcpy(out.buf + out.len, line, n);
+    out.len  += n;
+    out.first = false;
+    return true;
+}
+
+static void handleHistory()
+{
+    uint8_t  tier  = webServer.hasArg("tier") ? webServer.arg("tier").toInt() : 0;
+    uint32_t since = webServer.hasArg("since") ? webServer.arg("since").toInt() : 0;
+
+    if (tier >= HISTORY_TIERS) {
+        sendError(400, "tier must be 0-2");
+        return;
+    }
+
+    HistoryWriter out;
+    out.len   = snprintf(out.buf, sizeof(out.buf), "{\"period\":%u,\"now\":%u,\"points\":[",
+                         history.period(tier), (unsigned) history.newest());
+    out.first = true;
+
+    webServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    webServer.send(200, "application/json", "");
+    history.read(tier, since, writeHistoryPoint, &out);
+    if (out.len + 2 > sizeof(out.buf)) {
+        flushHistory(out);
+    }
+    memcpy(out.buf + out.len, "]}", 2);
+    out.len += 2;
+    flushHistory(out);
+    webServer.sendContent("");
+}
+
+void apiBegin()
+{
+    webServer.on("/api/status", HTTP_GET, handleStatus);
+    webServer.on("/api/setpoint", HTTP_PUT, handleSetpoint);
+    webServer.on("/api/tunings", HTTP_PUT, handleTunings);
+    webServer.on("/api/mode", HTTP_PUT, handleMode);
+    webServer.on("/api/cook", HTTP_PUT, handleCook);
+    webServer.on("/api/net", HTTP_GET, handleNet);
+    webServer.on("/api/history", HTTP_GET, handleHistory);
+    webServer.on("/api/telemetry", HTTP_GET, handleTelemetry);
+    webServer.on("/api/health", HTTP_GET, handleHealth);
+    webServer.on("/api/cascade", HTTP_GET, handleCascadeGet);
+    webServer.on("/api/cascade", HTTP_PUT, handleCascadePut);
+    webServer.on("/api/model", HTTP_GET, handleModelGet);
+    webServer.on("/api/model", HTTP_PUT, handleModelPut);
+    webServer.on("/api/bench", HTTP_GET, handleBench);
+    webServer.on("/api/calibration", HTTP_GET, handleCalibrationGet);
+    webServer.on("/api/calibration", HTTP_PUT, handleCalibrationPut);
+    webServer.on("/api/probe", HTTP_GET, handleProbeGet);
+    webServer.on("/api/probe", HTTP_PUT, handleProbePut);
+    webServer.on("/api/profile", HTTP_GET, handleProfileGet);
+    webServer.on("/api/profile", HTTP_PUT, handleProfilePut);
+    webServer.on("/api/log", HTTP_GET, handleLogGet);
+    webServer.on("/api/log", HTTP_PUT, handleLogPut);
+}
@@ -0,0 +1,47 @@
+#ifndef BGE_RESTAPI_HPP
+#define BGE_RESTAPI_HPP
+
+// JSON control API served next to the dashboard:
+//
+//   GET /api/status                                   current readings and settings
+//   PUT /api/setpoint  {"target": 275}                dome setpoint in F
+//   PUT /api/tunings   {"kp": 4, "ki": 0.2, "kd": 1}  any subset of the gains, and
+//                      {"rate": 2}                    fan %/s output rate limit, 0 for none
+//   PUT /api/mode      {"mode": "MANUAL", "fan": 40}  fan % only used in MANUAL
+//   PUT /api/mode      {"mode": "AUTOMATIC"}
+//   PUT /api/cook      {"new": true}                  start a new cook, see cookstate.hpp
+//   GET /api/net                                      link quality and outage counters
+//   GET /api/history?tier=0&since=<s>                 on-device history, see history.hpp
+//   GET /api/telemetry                                delivered and pending samples per sink, see telemetry.hpp
+//   GET /api/log                                      log level and queue counters, see log.hpp
+//   PUT /api/log       {"level": "debug"}             error, warn, info or debug
+//   GET /api/health                                   heap, stack and last reset, see health.hpp
+//   GET /api/cascade                                  meat loop settings and output, see cascade.hpp
+//   PUT /api/cascade   {"enabled": true,              meat target in F drives the dome
+//                       "meat": 203, "domeMin": 225,  setpoint, kept within domeMin-domeMax
+//                       "domeMax": 450}
+//   GET /api/profile                                  stored cook profile and progress, see profile.hpp
+//   PUT /api/profile   {"steps": [...], "run": true}  store steps, run starts or stops them:
+//                      {"ramp": 275, "minutes": 60}   ramp the dome to F over minutes
+//                      {"hold": 225, "minutes": 90}   hold the dome at F for minutes
+//                      {"hold": 225, "meat": 203}     or until the meat reaches F
+//   GET /api/model                                    dome model fit and controller in use, see model.hpp
+//   PUT /api/model     {"enabled": true,              feed-forward on or off, and
+//                       "mpc": false}                 the MPC in place of domePID
+//   GET /api/probe                                    thermocouple faults and read cost, see probe.hpp
+//   PUT /api/probe     {"safeFan": 20}                fan % while the dome probe is faulted, and
+//                      {"median": 3, "mean": 4,       the dome sample filter, see thermocouple.hpp
+//                       "decimate": 4}
+//   GET /api/bench                                    CPU cycles of the temperature path, see bench.hpp
+//   GET /api/calibration                              probe calibration, see thermocouple.hpp
+//   PUT /api/calibration                              readings against true F per probe,
+//       {"dome": [{"read": 33.4, "actual": 32}, ...]} an empty list clears the table
+//
+// Control requests answer with the status document, or {"error": "..."}.
+// History comes back as {"period": s, "now": s, "points": [[t, dome, meat,
+// fan, domeMin, domeMax], ...]} with null for gaps.
+
+// register the API routes on webServer
+void apiBegin();
+
+#endif // BGE_RESTAPI_HPP
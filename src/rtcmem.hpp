@@ -0,0 +1,13 @@
+#ifndef BGE_RTCMEM_HPP
+#define BGE_RTCMEM_HPP
+
+// Layout of the 512 byte RTC user memory, which survives every reset but a
+// power cycle. Offsets are in 4 byte blocks as ESP.rtcUserMemoryRead/Write
+// take them. Blocks 0-31 hold the OTA updater's boot command.
+
+#define RTC_WARMSTATE_BLOCK 32 // controller checkpoint, 8 blocks
+#define RTC_WARMSTATE_MAGIC 0x57524D31
+#define RTC_WIFICACHE_BLOCK 40 // last good AP and lease, 8 blocks
+#define RTC_WIFICACHE_MAGIC 0x57494631
+
+#endif // BGE_RTCMEM_HPP
@@ -0,0 +1,136 @@
+#include "sinks.hpp"
+
+#include <ESP8266WiFi.h>
+
+#include "bgemonitor.hpp"
+#include "httppost.hpp"
+#include "log.hpp"
+#include "netwatch.hpp"
+
+// samples per second
+#define SAMPLESPERSEC (1000 / CONTROLINTERVAL)
+
+// one decimal, or none for a bad reading
+static const char *temp(char *buf, size_t len, int16_t t, const char *none)
+{
+    if (t == TEMP_NONE) {
+        return none;
+    }
+    fmtFixed(buf, len, t, TEMP_SHIFT, 1);
+    return buf;
+}
+
+HistorySink::HistorySink() : TelemetrySink("history", 1000, SAMPLESPERSEC, TELEMETRY_MAXBATCH, false)
+{
+}
+
+size_t HistorySink::consume(const TelemetrySample *samples, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        const TelemetrySample &s = samples[i];
+        history.add(s.ms / 1000, s.dome, s.meat, s.fan);
+    }
+    return count;
+}
+
+SerialCsvSink::SerialCsvSink() :
+    TelemetrySink("serial", 1000, SERIALCSVINTERVAL * SAMPLESPERSEC, TELEMETRY_MAXBATCH, false), header(false)
+{
+}
+
+size_t SerialCsvSink::consume(const TelemetrySample *samples, size_t count)
+{
+    if (!header) {
+        header = true;
+        static const char columns[] = "ms,dome,meat,fan,target,heap,block\n";
+        logWrite(LOG_INFO, columns, sizeof(columns) - 1);
+    }
+    for (size_t i = 0; i < count; i++) {
+        const TelemetrySample &s = samples[i];
+        char dome[12], meat[12], fan[12], target[12], line[96];
+        // a bad reading shows as nan, which spreadsheets take as text
+        fmtDecimal(fan, sizeof(fan), (s.fan + 5) / 10, 1);
+        fmtFixed(target, sizeof(target), s.target, TEMP_SHIFT, 0);
+        int n = snprintf(line, sizeof(line), "%lu,%s,%s,%s,%s,%u,%u\n", (unsigned long) s.ms,
+                         temp(dome, sizeof(dome), s.dome, "nan"), temp(meat, sizeof(meat), s.meat, "nan"), fan,
+                         target, s.heapFree, s.maxBlock);
+        logWrite(LOG_INFO, line, min(n, (int) sizeof(line) - 1));
+    }
+    return count;
+}
+
+static WiFiClient tsClient;
+static HttpPost   tsPost(tsClient);
+
+// rounded to nearest
+static long mean(int32_t sum, uint16_t n)
+{
+    return (sum >= 0 ? sum + n / 2 : sum - n / 2) / n;
+}
+
+ThingSpeakSink::ThingSpeakSink() :
+    TelemetrySink("thingspeak", 1000, SAMPLESPERSEC, TELEMETRY_MAXBATCH, true), nextUpload(0),
+    heapMin(UINT16_MAX), blockMin(UINT16_MAX)
+{
+    memset(sum, 0, sizeof(sum));
+    memset(n, 0, sizeof(n));
+}
+
+size_t ThingSpeakSink::consume(const TelemetrySample *samples, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        const TelemetrySample &s = samples[i];
+        int16_t v[3] = { s.dome, s.meat, (int16_t) s.fan };
+        for (int f = 0; f < 3; f++) {
+            if (v[f] != TEMP_NONE) {
+                sum[f] += v[f];
+                n[f]++;
+            }
+        }
+        heapMin  = min(heapMin, s.heapFree);
+        blockMin = min(blockMin, s.maxBlock);
+    }
+
+    if ((long) (millis() - nextUpload) >= 0) {
+        nextUpload = millis() + TSINTERVAL * 1000;
+        upload();
+    }
+    return count;
+}
+
+void ThingSpeakSink::poll()
+{
+    int status = tsPost.poll();
+    if (status != HTTP_PENDING) {
+        netSendResult(status == 200);
+    }
+}
+
+void ThingSpeakSink::upload()
+{
+    // nothing sensible to send without a dome reading
+    bool haveDome = n[0] > 0;
+    if (haveDome && netCanSend()) {
+        char value[12], dome[24], meat[24] = "", fan[24] = "", body[144];
+        snprintf(dome, sizeof(dome), "&field1=%s", temp(value, sizeof(value), mean(sum[0], n[0]), ""));
+        if (n[1] > 0) {
+            snprintf(meat, sizeof(meat), "&field2=%s", temp(value, sizeof(value), mean(sum[1], n[1]), ""));
+        }
+        // the channel has always carried fan-on ms per window
+        if (n[2] > 0) {
+            snprintf(fan, sizeof(fan), "&field3=%ld", mean(sum[2], n[2]) * FANWINDOW / (100L * FAN_SCALE));
+        }
+        int len = snprintf(body, sizeof(body), "api_key=%s%s%s%s&field4=%u&field5=%u", TSAPIKEY, dome, meat, fan,
+                           heapMin, blockMin);
+        if (!tsPost.start(TSHOST, "/update", body, len)) {
+            logWarn("ThingSpeak update skipped, the last one is still going");
+        }
+    } else if (!haveDome) {
+        logWarn("Error: bad data!");
+    }
+
+    memset(sum, 0, sizeof(sum));
+    memset(n, 0, sizeof(n));
+    heapMin  = UINT16_MAX;
+    blockMin = UINT16_MAX;
+}
@@ -0,0 +1,57 @@
+#ifndef BGE_SINKS_HPP
+#define BGE_SINKS_HPP
+
+#include "telemetry.hpp"
+
+// The stock telemetry sinks. MQTT lives in mqttsink.hpp.
+
+// ThingSpeak channel 1257165, its write key picks the channel
+#define TSHOST   "api.thingspeak.com"
+#define TSAPIKEY "XR8XPHTH5MX4AGQN"
+// TSINTERVAL = number of seconds between ThingSpeak updates
+#define TSINTERVAL 15
+
+// seconds between lines of the serial CSV log
+#define SERIALCSVINTERVAL 15
+
+// 1 Hz into the in-RAM cook history
+class HistorySink : public TelemetrySink
+{
+  public:
+    HistorySink();
+    size_t consume(const TelemetrySample *samples, size_t count);
+};
+
+// "ms,dome,meat,fan%,target,heap,block" lines on the serial port
+class SerialCsvSink : public TelemetrySink
+{
+  public:
+    SerialCsvSink();
+    size_t consume(const TelemetrySample *samples, size_t count);
+
+  private:
+    bool header;
+};
+
+// Uploads the mean of the 1 Hz samples of each TSINTERVAL, which smooths
+// the channel instead of catching whatever the dome read at upload time.
+// Fields 4 and 5 carry the least free heap and largest free block seen.
+// The POST runs from poll(), a step per pass, see httppost.hpp.
+class ThingSpeakSink : public TelemetrySink
+{
+  public:
+    ThingSpeakSink();
+    size_t consume(const TelemetrySample *samples, size_t count);
+    void   poll();
+
+  private:
+    void upload();
+
+    unsigned long nextUpload;
+    int32_t       sum[3]; // fixed point, as in TelemetrySample
+    uint16_t      n[3];
+    uint16_t      heapMin;
+    uint16_t      blockMin;
+};
+
+#endif // BGE_SINKS_HPP
@@ -0,0 +1,114 @@
+#include "telemetry.hpp"
+
+static TelemetrySample   ring[TELEMETRY_RING];
+static TelemetrySample   batchBuf[TELEMETRY_MAXBATCH];
+static volatile uint32_t produced = 0; // samples written so far
+
+static TelemetrySink *sinks[TELEMETRY_MAXSINKS];
+static uint8_t        sinkCount = 0;
+
+static_assert((TELEMETRY_RING & (TELEMETRY_RING - 1)) == 0, "ring size must be a power of two");
+static_assert(TELEMETRY_MAXBATCH <= TELEMETRY_RING, "a batch cannot exceed the ring");
+static_assert(sizeof(ring) + sizeof(batchBuf) <= TELEMETRY_BUDGET, "telemetry buffers exceed their budget");
+
+// Producer and consumers share one core and only interleave at yield
+// points, so ordering the stores as the compiler sees them is enough.
+#define telemetryBarrier() __asm__ __volatile__("" ::: "memory")
+
+TelemetrySink::TelemetrySink(const char *name, uint16_t interval, uint16_t stride, uint8_t batch, bool needsNetwork) :
+    name(name), interval(interval), stride(stride > 0 ? stride : 1), batch(min(batch, (uint8_t) TELEMETRY_MAXBATCH)),
+    needsNetwork(needsNetwork), cursor(0), nextRun(0), delivered(0), overruns(0)
+{
+}
+
+void telemetryProduce(TelemetrySample &sample)
+{
+    uint32_t seq = produced;
+
+    sample.seq = seq;
+    sample.ms  = millis();
+    ring[seq & (TELEMETRY_RING - 1)] = sample;
+
+    // the slot must be complete before readers can see it
+    telemetryBarrier();
+    produced = seq + 1;
+}
+
+bool telemetryAddSink(TelemetrySink *sink)
+{
+    if (sinkCount == TELEMETRY_MAXSINKS || strlen(sink->name) > TELEMETRY_NAMEMAX) {
+        return false;
+    }
+    // start with what is produced from now on
+    sink->cursor       = produced;
+    sinks[sinkCount++] = sink;
+    return true;
+}
+
+static void runSink(TelemetrySink *sink)
+{
+    uint32_t head = produced;
+    telemetryBarrier();
+
+    if (head - sink->cursor > TELEMETRY_RING) {
+        sink->overruns += head - sink->cursor - TELEMETRY_RING;
+        sink->cursor    = head - TELEMETRY_RING;
+    }
+
+    // copy out the samples this sink wants
+    size_t   n   = 0;
+    uint32_t seq = sink->cursor;
+    for (; seq != head && n < sink->batch; seq++) {
+        if (seq % sink->stride == 0) {
+            batchBuf[n++] = ring[seq & (TELEMETRY_RING - 1)];
+        }
+    }
+
+    // a slot the producer started to reuse while we copied is not trusted
+    telemetryBarrier();
+    uint32_t now  = produced;
+    size_t   skip = 0;
+    while (skip < n && now - batchBuf[skip].seq >= TELEMETRY_RING) {
+        skip++;
+    }
+    sink->overruns += skip;
+
+    size_t used = n > skip ? sink->consume(batchBuf + skip, n - skip) : 0;
+    sink->delivered += used;
+
+    // everything scanned is done with, unless the sink left some behind
+    sink->cursor = skip + used < n ? batchBuf[skip + used].seq : seq;
+}
+
+void telemetryLoop(bool online)
+{
+    unsigned long now = millis();
+
+    for (uint8_t i = 0; i < sinkCount; i++) {
+        TelemetrySink *sink = sinks[i];
+        if (sink->needsNetwork && !online) {
+            continue;
+        }
+        sink->poll();
+        if ((long) (now - sink->nextRun) < 0) {
+            continue;
+        }
+        sink->nextRun = now + sink->interval;
+        runSink(sink);
+    }
+}
+
+uint8_t telemetrySinkCount()
+{
+    return sinkCount;
+}
+
+TelemetrySink *telemetrySink(uint8_t i)
+{
+    return i < sinkCount ? sinks[i] : NULL;
+}
+
+uint32_t telemetryProduced()
+{
+    return produced;
+}
@@ -0,0 +1,80 @@
+#ifndef BGE_TELEMETRY_HPP
+#define BGE_TELEMETRY_HPP
+
+#include <Arduino.h>
+
+#include "fixed.hpp"
+
+// Telemetry pipeline. The control pass produces every sample exactly once
+// into a ring; each registered sink reads the ring through its own cursor
+// at its own rate and batch size. The producer never waits: a sink that
+// falls more than a ring behind skips ahead and counts what it lost, so a
+// stalled upload can hold back neither the controller nor the other sinks.
+
+#define TELEMETRY_RING     64   // samples, a power of two
+#define TELEMETRY_MAXBATCH 16
+#define TELEMETRY_MAXSINKS 6
+#define TELEMETRY_NAMEMAX  12   // characters in a sink name
+#define TELEMETRY_BUDGET   2048 // bytes for ring and batch buffer
+
+struct TelemetrySample {
+    uint32_t seq;
+    uint32_t ms;
+    int16_t  dome;       // 1/16 F, TEMP_NONE for a bad reading, see fixed.hpp
+    int16_t  meat;
+    int16_t  target;
+    uint16_t fan;        // 0.01 %
+    uint16_t heapFree;   // bytes, from the last health sample
+    uint16_t maxBlock;
+    uint8_t  fragmentation;
+    uint8_t  flags;      // TELEMETRY_ flags below
+};
+
+// the memory health alert is raised
+#define TELEMETRY_HEAPALERT 0x01
+// a probe is faulted, see probe.hpp
+#define TELEMETRY_DOMEFAULT 0x02
+#define TELEMETRY_MEATFAULT 0x04
+
+class TelemetrySink
+{
+  public:
+    // interval: ms between calls; stride: deliver every nth sample only;
+    // batch: most samples per call
+    TelemetrySink(const char *name, uint16_t interval, uint16_t stride, uint8_t batch, bool needsNetwork);
+    virtual ~TelemetrySink() {}
+
+    // take samples, oldest first, and return how many were used; the rest
+    // are offered again on the next call
+    virtual size_t consume(const TelemetrySample *samples, size_t count) = 0;
+
+    // called on every pipeline pass, for connection upkeep
+    virtual void poll() {}
+
+    const char *name;
+    uint16_t    interval;
+    uint16_t    stride;
+    uint8_t     batch;
+    bool        needsNetwork;
+
+    // pipeline bookkeeping
+    uint32_t      cursor;    // next sequence number to look at
+    unsigned long nextRun;
+    uint32_t      delivered;
+    uint32_t      overruns;  // samples skipped because the sink fell behind
+};
+
+// producer side, called from the control pass; stamps seq and ms
+void telemetryProduce(TelemetrySample &sample);
+
+// add a sink, false when all slots are taken or its name is too long
+bool telemetryAddSink(TelemetrySink *sink);
+
+// run the sinks that are due, call from loop()
+void telemetryLoop(bool online);
+
+uint8_t        telemetrySinkCount();
+TelemetrySink *telemetrySink(uint8_t i);
+uint32_t       telemetryProduced();
+
+#endif // BGE_TELEMETRY_HPP
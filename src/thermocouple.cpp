@@ -0,0 +1,241 @@
+#include "thermocouple.hpp"
+
+#include <LittleFS.h>
+
+#include "crc32.hpp"
+#include "log.hpp"
+#include "probe.hpp"
+
+CalConfig calConfig;
+
+CalTable::CalTable()
+{
+    build(NULL, 0);
+}
+
+void CalTable::build(const CalPoint *points, uint8_t count)
+{
+    // the chip's own conversion, 1/16 F per count and at count 0
+    const double chip = 0.25 * 1.8 * TEMP_SCALE;
+    const double zero = 32.0 * TEMP_SCALE;
+    double       x[CAL_MAXPOINTS], y[CAL_MAXPOINTS];
+    uint8_t      n = max(count, (uint8_t) 2);
+
+    x[0] = 0;
+    y[0] = zero;
+    for (uint8_t i = 0; i < count; i++) {
+        x[i] = (points[i].read - zero) / chip;
+        y[i] = points[i].actual;
+    }
+    if (count < 2) {
+        // an offset on the chip's slope
+        x[1] = x[0] + 1;
+        y[1] = y[0] + chip;
+    }
+
+    segments = n - 1;
+    for (uint8_t k = 0; k < segments; k++) {
+        double slope = (y[k + 1] - y[k]) / (x[k + 1] - x[k]);
+        long   start = k == 0 ? 0 : constrain(lround(x[k]), 0L, KTC_COUNTS - 1L);
+        seg[k].start = start;
+        seg[k].base  = constrain(lround(y[k] + slope * (start - x[k])), INT16_MIN + 1L, (long) INT16_MAX);
+        seg[k].slope = lround(slope * 65536);
+    }
+
+    uint8_t k = 0;
+    for (int b = 0; b < (KTC_COUNTS >> CAL_BUCKET); b++) {
+        while (k + 1 < segments && (b << CAL_BUCKET) >= seg[k + 1].start) {
+            k++;
+        }
+        bucket[b] = k;
+    }
+}
+
+Thermocouple::Thermocouple(uint8_t sclk, uint8_t cs, uint8_t miso)
+    : sclk(sclk), cs(cs), miso(miso), head(0), phase(0), median(KTC_MEDIAN), mean(KTC_MEAN),
+      decimate(KTC_DECIMATE), primed(false), readTime(0), filterTime(0)
+{
+}
+
+void Thermocouple::begin()
+{
+    pinMode(cs, OUTPUT);
+    pinMode(sclk, OUTPUT);
+    pinMode(miso, INPUT);
+    digitalWrite(cs, HIGH);
+}
+
+// The chip needs 100 ns around each edge, the library waited 1 ms and
+// held the control pass for 34 ms a reading. CS sits on the HSPI MOSI pin,
+// so hardware SPI is out and this stays bit-banged.
+int16_t Thermocouple::readRaw()
+{
+    uint16_t v = 0;
+
+    digitalWrite(cs, LOW);
+    delayMicroseconds(KTC_HALFCLOCK);
+    for (int i = 15; i >= 0; i--) {
+        digitalWrite(sclk, LOW);
+        delayMicroseconds(KTC_HALFCLOCK);
+        if (digitalRead(miso)) {
+            v |= 1 << i;
+        }
+        digitalWrite(sclk, HIGH);
+        delayMicroseconds(KTC_HALFCLOCK);
+    }
+    // raising CS starts the next conversion
+    digitalWrite(cs, HIGH);
+
+    // bit 2 is set when the thermocouple is open
+    return v & 0x4 ? KTC_OPEN : v >> 3;
+}
+
+bool Thermocouple::sample()
+{
+    uint32_t start = ESP.getCycleCount();
+    int16_t  count = readRaw();
+    readTime       = ESP.getCycleCount() - start;
+
+    // the ring starts out full of the first sample
+    if (!primed) {
+        for (uint8_t i = 0; i < KTC_RING; i++) {
+            ring[i] = count;
+        }
+        primed = true;
+    }
+    ring[head] = count;
+    head       = (head + 1) & (KTC_RING - 1);
+
+    if (++phase < decimate) {
+        return false;
+    }
+    phase = 0;
+    return true;
+}
+
+int16_t Thermocouple::filtered()
+{
+    uint32_t start = ESP.getCycleCount();
+    int32_t  sum   = 0;
+    int16_t  result;
+
+    for (uint8_t m = 0; m < mean; m++) {
+        // the m-th newest run of median samples, insertion sorted
+        int16_t run[KTC_MAXMEDIAN];
+        uint8_t newest = head - 1 - m;
+        for (uint8_t i = 0; i < median; i++) {
+            int16_t v = ring[(newest - i) & (KTC_RING - 1)];
+            uint8_t j = i;
+            for (; j > 0 && run[j - 1] > v; j--) {
+                run[j] = run[j - 1];
+            }
+            run[j] = v;
+        }
+        if (run[median / 2] == KTC_OPEN) {
+            sum = -1;
+            break;
+        }
+        sum += run[median / 2];
+    }
+    if (sum < 0) {
+        result = TEMP_NONE;
+    } else {
+        result = calibration.apply(((sum << KTC_FRACBITS) + mean / 2) / mean);
+    }
+    filterTime = ESP.getCycleCount() - start;
+    return result;
+}
+
+bool Thermocouple::setFilter(uint8_t median, uint8_t mean, uint8_t decimate)
+{
+    if (median < 1 || median > KTC_MAXMEDIAN || median % 2 == 0 || mean < 1 || mean > KTC_MAXMEAN ||
+        median + mean - 1 > KTC_RING || decimate < 1) {
+        return false;
+    }
+    this->median   = median;
+    this->mean     = mean;
+    this->decimate = decimate;
+    return true;
+}
+
+static Thermocouple *const probes[CAL_PROBES] = { &ktc, &meatKtc };
+
+static void apply()
+{
+    for (uint8_t p = 0; p < CAL_PROBES; p++) {
+        probes[p]->calibration.build(calConfig.points[p], calConfig.count[p]);
+    }
+}
+
+static void save()
+{
+    calConfig.magic = CAL_MAGIC;
+    calConfig.crc   = crc32Of(&calConfig, offsetof(CalConfig, crc));
+
+    File f = LittleFS.open(CAL_FILE, "w");
+    if (f) {
+        f.write((const uint8_t *) &calConfig, sizeof(calConfig));
+        f.close();
+    }
+}
+
+void calibrationBegin()
+{
+    // the first reading needs the tables, before cookStateBegin() has the
+    // filesystem up
+    File f;
+    if (LittleFS.begin()) {
+        f = LittleFS.open(CAL_FILE, "r");
+    }
+    bool ok = f && f.read((uint8_t *) &calConfig, sizeof(calConfig)) == sizeof(calConfig) &&
+              calConfig.magic == CAL_MAGIC && calConfig.crc == crc32Of(&calConfig, offsetof(CalConfig, crc)) &&
+              calConfig.count[0] <= CAL_MAXPOINTS && calConfig.count[1] <= CAL_MAXPOINTS;
+    if (f) {
+        f.close();
+    }
+    if (!ok) {
+        memset(&calConfig, 0, sizeof(calConfig));
+    }
+    apply();
+    for (uint8_t p = 0; p < CAL_PROBES; p++) {
+        if (calConfig.count[p] > 0) {
+            logInfo("probe %u calibrated at %u points", p, calConfig.count[p]);
+        }
+    }
+}
+
+const char *calibrationConfigure(uint8_t probe, CalPoint *points, uint8_t count)
+{
+    if (probe >= CAL_PROBES || count > CAL_MAXPOINTS) {
+        return "at most 6 points per probe";
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        if (points[i].read < PROBE_MINF * TEMP_SCALE || points[i].read > PROBE_MAXF * TEMP_SCALE ||
+            points[i].actual < PROBE_MINF * TEMP_SCALE || points[i].actual > PROBE_MAXF * TEMP_SCALE) {
+            return "points must be 0-1000 F";
+        }
+    }
+    // insertion sort by read, there are only a few
+    for (uint8_t i = 1; i < count; i++) {
+        CalPoint p = points[i];
+        uint8_t  j = i;
+        for (; j > 0 && points[j - 1].read > p.read; j--) {
+            points[j] = points[j - 1];
+        }
+        points[j] = p;
+    }
+    for (uint8_t i = 1; i < count; i++) {
+        double span  = points[i].read - points[i - 1].read;
+        double slope = (points[i].actual - points[i - 1].actual) / span;
+        if (span < CAL_MINSPAN * TEMP_SCALE || !(slope >= 1 / CAL_MAXSLOPE && slope <= CAL_MAXSLOPE)) {
+            return "points too close or too far off";
+        }
+    }
+
+    calConfig.count[probe] = count;
+    memcpy(calConfig.points[probe], points, count * sizeof(CalPoint));
+    memset(calConfig.points[probe] + count, 0, (CAL_MAXPOINTS - count) * sizeof(CalPoint));
+    probes[probe]->calibration.build(points, count);
+    save();
+    return NULL;
+}
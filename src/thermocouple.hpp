@@ -0,0 +1,151 @@
+#ifndef BGE_THERMOCOUPLE_HPP
+#define BGE_THERMOCOUPLE_HPP
+
+#include <Arduino.h>
+
+#include "fixed.hpp"
+
+// MAX6675 thermocouple reads with per-probe calibration.
+//
+// The MAX6675 compensates the cold junction itself, but a cheap probe and
+// board together still read several degrees off at smoking temperatures,
+// and not by the same amount at 32 as at 212. Each probe gets a table of
+// up to CAL_MAXPOINTS (reading, actual) pairs, e.g. from an ice bath and
+// boiling water, kept in flash. Between points the correction is linear,
+// beyond the ends the nearest segment carries on; one point is an offset,
+// none reads as the chip does.
+//
+// The table is turned into segments over the raw 12-bit count when it is
+// loaded, with the Celsius to Fahrenheit conversion folded in, so a
+// reading costs a bucket lookup, a multiply and a shift and no floating
+// point at all. Temperatures come out in 1/TEMP_SCALE F, see fixed.hpp.
+//
+// Raw counts also go into a ring, sampled as fast as the chip converts.
+// Every decimate samples the filter takes the median of each run of
+// median counts, which drops spikes picked up by the probe wire, and
+// averages mean of those medians. The average keeps KTC_FRACBITS below
+// the 0.25 C quantum, so the small noise on a steady fire resolves the
+// temperature finer than any single reading. All of it is integer.
+
+#define KTC_OPEN     -1   // readRaw() when the thermocouple is open
+#define KTC_COUNTS   4096 // 12 bits of 0.25 C
+#define KTC_FRACBITS 4    // filtered counts carry 1/16 count
+#define KTC_HALFCLOCK 1   // us per SCK phase, the chip takes up to 4.3 MHz
+
+// sample ring and filter defaults; median is odd
+#define KTC_RING      16 // samples, a power of two
+#define KTC_MAXMEDIAN 7
+#define KTC_MAXMEAN   8
+#define KTC_MEDIAN    5
+#define KTC_MEAN      4
+#define KTC_DECIMATE  4 // samples per filtered output
+
+#define CAL_FILE      "/calib.bin"
+#define CAL_MAGIC     0x43414c31
+#define CAL_MAXPOINTS 6
+#define CAL_PROBES    2   // dome and meat
+#define CAL_BUCKET    6   // log2 of the counts per lookup bucket
+#define CAL_MAXSLOPE  1.5 // a steeper or flatter correction is a typo
+#define CAL_MINSPAN   10  // F between points
+
+struct CalPoint {
+    int16_t read;   // what the probe said, 1/16 F
+    int16_t actual; // what it should have said
+};
+
+struct CalConfig {
+    uint32_t magic;
+    uint8_t  count[CAL_PROBES];
+    uint8_t  reserved[2];
+    CalPoint points[CAL_PROBES][CAL_MAXPOINTS];
+    uint32_t crc;
+};
+
+// a calibration turned into straight segments over the raw count
+class CalTable
+{
+  public:
+    CalTable();
+
+    // points sorted by read; count 0 is the chip's own conversion
+    void build(const CalPoint *points, uint8_t count);
+
+    // count in 1/16 counts to 1/16 F, integer only
+    int16_t apply(int32_t q) const
+    {
+        uint8_t k = bucket[q >> (CAL_BUCKET + KTC_FRACBITS)];
+        while (k + 1 < segments && q >= (int32_t) seg[k + 1].start << KTC_FRACBITS) {
+            k++;
+        }
+        const Segment &s  = seg[k];
+        int64_t        dx = q - ((int32_t) s.start << KTC_FRACBITS);
+        int32_t        y  = s.base + (int32_t) ((dx * s.slope + (1 << (15 + KTC_FRACBITS))) >> (16 + KTC_FRACBITS));
+        return constrain(y, INT16_MIN + 1, INT16_MAX);
+    }
+
+  private:
+    struct Segment {
+        int16_t start; // first count
+        int16_t base;  // 1/16 F at start
+        int32_t slope; // 1/16 F per count, Q16
+    };
+
+    Segment seg[CAL_MAXPOINTS];
+    uint8_t segments;
+    uint8_t bucket[KTC_COUNTS >> CAL_BUCKET]; // segment at the bucket's first count
+};
+
+class Thermocouple
+{
+  public:
+    Thermocouple(uint8_t sclk, uint8_t cs, uint8_t miso);
+
+    void begin();
+
+    // 12-bit count in 0.25 C, or KTC_OPEN
+    int16_t readRaw();
+
+    // one calibrated reading, in 1/16 F, or TEMP_NONE
+    int16_t read()
+    {
+        int16_t count = readRaw();
+        return count == KTC_OPEN ? TEMP_NONE : calibration.apply((int32_t) count << KTC_FRACBITS);
+    }
+
+    // read a sample into the ring, true when a filtered output is due
+    bool sample();
+
+    // the filter over the newest samples, calibrated, or TEMP_NONE once
+    // the median itself reads open
+    int16_t filtered();
+
+    // false if the settings do not fit the ring
+    bool setFilter(uint8_t median, uint8_t mean, uint8_t decimate);
+
+    // CPU cycles the last sample() spent on SPI and filtered() in total
+    uint32_t readCycles() const { return readTime; }
+    uint32_t filterCycles() const { return filterTime; }
+
+    CalTable calibration;
+
+  private:
+    uint8_t  sclk, cs, miso;
+    int16_t  ring[KTC_RING];
+    uint8_t  head;  // next slot
+    uint8_t  phase; // samples since the last output
+    uint8_t  median, mean, decimate;
+    bool     primed;
+    uint32_t readTime, filterTime;
+};
+
+extern Thermocouple ktc, meatKtc;
+extern CalConfig    calConfig;
+
+// load the tables, call before the first reading
+void calibrationBegin();
+
+// replace one probe's table; returns an error message, or NULL once
+// applied and saved
+const char *calibrationConfigure(uint8_t probe, CalPoint *points, uint8_t count);
+
+#endif // BGE_THERMOCOUPLE_HPP
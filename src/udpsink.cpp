@@ -0,0 +1,84 @@
+#include "udpsink.hpp"
+
+#include <ESP8266WiFi.h>
+#include <WiFiUdp.h>
+
+#include "bgemonitor.hpp"
+#include "crc32.hpp"
+#include "log.hpp"
+
+static_assert(FAN_SCALE == 100, "records carry the fan in 0.01 %");
+
+static WiFiUDP udp;
+
+static uint8_t *put16(uint8_t *p, uint16_t v)
+{
+    *p++ = v & 0xff;
+    *p++ = v >> 8;
+    return p;
+}
+
+static uint8_t *put32(uint8_t *p, uint32_t v)
+{
+    p = put16(p, v & 0xffff);
+    return put16(p, v >> 16);
+}
+
+// 1/16 F to tenths, or 0 with the valid bit left clear
+static int16_t tenths(int16_t t)
+{
+    return t == TEMP_NONE ? 0 : constrain(roundShift((int32_t) t * 10, TEMP_SHIFT), -32767L, 32767L);
+}
+
+UdpSink::UdpSink() :
+    TelemetrySink("udp", UDPBATCH * UDPSTRIDE * CONTROLINTERVAL, UDPSTRIDE, UDPBATCH, true),
+    started(false), address(0), device(0)
+{
+}
+
+size_t UdpSink::consume(const TelemetrySample *samples, size_t count)
+{
+    if (UDPTARGET[0] == '\0') {
+        return count;
+    }
+    if (!started) {
+        IPAddress ip;
+        started = true;
+        device  = ESP.getChipId();
+        if (ip.fromString(UDPTARGET)) {
+            address = ip;
+        } else {
+            logError("udp: bad target %s", UDPTARGET);
+        }
+    }
+    if (address == 0) {
+        return count;
+    }
+
+    uint8_t packet[UDPBATCH * UDPRECORD];
+    uint8_t *p = packet;
+
+    for (size_t i = 0; i < count; i++) {
+        const TelemetrySample &s = samples[i];
+        uint8_t *record = p;
+
+        p    = put16(p, UDPMAGIC);
+        *p++ = UDPVERSION;
+        *p++ = (s.dome == TEMP_NONE ? 0 : 1) | (s.meat == TEMP_NONE ? 0 : 2) | (s.flags & TELEMETRY_DOMEFAULT ? 4 : 0) |
+               (s.flags & TELEMETRY_MEATFAULT ? 8 : 0);
+        p    = put32(p, device);
+        p    = put32(p, s.seq / UDPSTRIDE);
+        p    = put32(p, s.ms);
+        p    = put16(p, tenths(s.dome));
+        p    = put16(p, tenths(s.meat));
+        p    = put16(p, s.fan);
+        p    = put16(p, tenths(s.target));
+        p    = put32(p, crc32Of(record, p - record));
+    }
+
+    // fire and forget, a lost datagram shows up as a gap at the collector
+    udp.beginPacket(IPAddress(address), UDPPORT);
+    udp.write(packet, p - packet);
+    udp.endPacket();
+    return count;
+}
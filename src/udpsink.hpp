@@ -0,0 +1,46 @@
+#ifndef BGE_UDPSINK_HPP
+#define BGE_UDPSINK_HPP
+
+#include "telemetry.hpp"
+
+// High-rate telemetry for LAN collectors, see scripts/udpcollect.py.
+//
+// Each datagram carries up to UDPBATCH fixed 28-byte records, little-endian:
+//
+//   0  u16 magic 0x4742 ("BG")   12 u32 millis
+//   2  u8  version               16 i16 dome, 0.1 F
+//   3  u8  flags, bit 0 dome     18 i16 meat, 0.1 F
+//          valid, bit 1 meat     20 u16 fan, 0.01 %
+//          valid, bit 2 dome     22 i16 target, 0.1 F
+//          probe faulted, bit 3  24 u32 CRC-32 of bytes 0-23
+//          meat probe faulted
+//   4  u32 device (chip id)
+//   8  u32 sequence
+//
+// The sequence counts samples at the sink's stride, so a gap on the wire
+// and a sample the sink skipped look the same to the collector.
+
+// destination address, a unicast host or 255.255.255.255; empty leaves UDP off
+#define UDPTARGET ""
+#define UDPPORT   4210
+#define UDPSTRIDE 1 // send every nth control sample, 1 is 10 Hz
+#define UDPBATCH  4 // records per datagram
+
+#define UDPMAGIC   0x4742
+#define UDPVERSION 1
+#define UDPRECORD  28
+
+class UdpSink : public TelemetrySink
+{
+  public:
+    UdpSink();
+
+    size_t consume(const TelemetrySample *samples, size_t count);
+
+  private:
+    bool     started;
+    uint32_t address;
+    uint32_t device;
+};
+
+#endif // BGE_UDPSINK_HPP
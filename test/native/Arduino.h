@@ -0,0 +1,148 @@
+#ifndef BGE_TEST_ARDUINO_H
+#define BGE_TEST_ARDUINO_H
+
+// Just enough of the ESP8266 Arduino core to build the hardware independent
+// modules on the host for the native test env. Time only moves when a test
+// calls hostAdvance(), so runs are repeatable.
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include <chrono>
+
+typedef uint8_t byte;
+
+#define PGM_P   const char *
+#define PSTR(s) (s)
+
+#define LOW    0
+#define HIGH   1
+#define INPUT  0
+#define OUTPUT 1
+
+using std::max;
+using std::min;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+inline unsigned long &hostMillis()
+{
+    static unsigned long ms;
+    return ms;
+}
+
+inline void hostAdvance(unsigned long ms)
+{
+    hostMillis() += ms;
+}
+
+inline unsigned long millis()
+{
+    return hostMillis();
+}
+
+inline unsigned long micros()
+{
+    return hostMillis() * 1000;
+}
+
+inline void yield()
+{
+}
+
+inline void delay(unsigned long ms)
+{
+    hostAdvance(ms);
+}
+
+inline void delayMicroseconds(unsigned int)
+{
+}
+
+// pins read low unless a test puts a device behind them
+struct HostPins {
+    void (*write)(uint8_t pin, uint8_t value);
+    int (*read)(uint8_t pin);
+};
+
+static HostPins hostPins;
+
+inline void pinMode(uint8_t, uint8_t)
+{
+}
+
+inline void digitalWrite(uint8_t pin, uint8_t value)
+{
+    if (hostPins.write) {
+        hostPins.write(pin, value);
+    }
+}
+
+inline int digitalRead(uint8_t pin)
+{
+    return hostPins.read ? hostPins.read(pin) : LOW;
+}
+
+// why the chip last started, as the core's user_interface.h has it
+enum rst_reason {
+    REASON_DEFAULT_RST,
+    REASON_WDT_RST,
+    REASON_EXCEPTION_RST,
+    REASON_SOFT_WDT_RST,
+    REASON_SOFT_RESTART,
+    REASON_DEEP_SLEEP_AWAKE,
+    REASON_EXT_SYS_RST
+};
+
+struct rst_info {
+    uint32_t reason;
+};
+
+// the cycle counter runs on the host's clock, one cycle a nanosecond, so
+// on-device cycle figures and host benchmarks read the same way. RTC user
+// memory lasts as long as the process; a test simulating a reset sets
+// resetInfo.reason to the cause.
+class EspClass
+{
+  public:
+    uint32_t getCycleCount()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+    uint32_t getCpuFreqMHz() { return 1000; }
+
+    bool rtcUserMemoryRead(uint32_t offset, uint32_t *data, size_t size)
+    {
+        if (offset * 4 + size > sizeof(rtcMemory)) {
+            return false;
+        }
+        memcpy(data, rtcMemory + offset * 4, size);
+        return true;
+    }
+
+    bool rtcUserMemoryWrite(uint32_t offset, uint32_t *data, size_t size)
+    {
+        if (offset * 4 + size > sizeof(rtcMemory)) {
+            return false;
+        }
+        memcpy(rtcMemory + offset * 4, data, size);
+        return true;
+    }
+
+    rst_info *getResetInfoPtr() { return &resetInfo; }
+
+    rst_info resetInfo;
+    uint8_t  rtcMemory[512];
+};
+
+static EspClass ESP __attribute__((unused));
+
+#endif // BGE_TEST_ARDUINO_H
@@ -0,0 +1,28 @@
+#ifndef BGE_TEST_CLIENT_H
+#define BGE_TEST_CLIENT_H
+
+// The socket calls our network code makes on an Arduino Client; tests
+// implement them to stand in for the other end.
+
+#include <Arduino.h>
+
+class Client
+{
+  public:
+    virtual ~Client() {}
+
+    virtual int     connect(const char *host, uint16_t port) = 0;
+    virtual size_t  write(const uint8_t *buf, size_t size) = 0;
+    virtual int     availableForWrite() = 0;
+    virtual int     available() = 0;
+    virtual int     read() = 0;
+    virtual uint8_t connected() = 0;
+    virtual void    stop() = 0;
+
+    void setTimeout(unsigned long ms) { timeout = ms; }
+
+  protected:
+    unsigned long timeout = 1000;
+};
+
+#endif // BGE_TEST_CLIENT_H
@@ -0,0 +1,65 @@
+#ifndef BGE_TEST_ESP8266WIFI_H
+#define BGE_TEST_ESP8266WIFI_H
+
+// A WiFiClient with a scripted server behind it. Every connection is
+// answered with wifiServer.reply and closed; what was written to the last
+// one is kept in fixed storage, so a test can look at it without the
+// stand-in allocating anything itself.
+
+#include <Client.h>
+
+struct WiFiServerScript {
+    const char *reply;     // sent back on every connection, NULL for none
+    bool        refuse;    // connect() fails
+    bool        stall;     // connections stay open and silent
+    char        sent[1024];
+    size_t      sentLen;   // bytes written to the last connection
+    unsigned    connects;
+};
+
+static WiFiServerScript wifiServer;
+
+class WiFiClient : public Client
+{
+  public:
+    int connect(const char *, uint16_t)
+    {
+        wifiServer.connects++;
+        wifiServer.sentLen = 0;
+        pos                = 0;
+        open               = !wifiServer.refuse;
+        return open;
+    }
+
+    size_t write(const uint8_t *buf, size_t size)
+    {
+        if (!open) {
+            return 0;
+        }
+        size_t n = min(size, sizeof(wifiServer.sent) - wifiServer.sentLen);
+        memcpy(wifiServer.sent + wifiServer.sentLen, buf, n);
+        wifiServer.sentLen += n;
+        return n;
+    }
+
+    int availableForWrite() { return open ? 1460 : 0; }
+    int available() { return open && wifiServer.reply ? strlen(wifiServer.reply + pos) : 0; }
+
+    int read()
+    {
+        if (available() == 0) {
+            return -1;
+        }
+        return (uint8_t) wifiServer.reply[pos++];
+    }
+
+    // the server closes once it has said its piece
+    uint8_t connected() { return open && (wifiServer.stall || available() > 0); }
+    void    stop() { open = false; }
+
+  private:
+    bool   open = false;
+    size_t pos  = 0;
+};
+
+#endif // BGE_TEST_ESP8266WIFI_H
@@ -0,0 +1,102 @@
+#ifndef BGE_TEST_LITTLEFS_H
+#define BGE_TEST_LITTLEFS_H
+
+// A file system in memory. It starts empty and keeps what was written for
+// the life of the process, so a test can restart a module over its own
+// files the way a reset would; LittleFS.files is there to look at or
+// clear. Only the calls our modules make.
+
+#include <Arduino.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+enum SeekMode { SeekSet, SeekCur, SeekEnd };
+
+class File
+{
+  public:
+    File() : data(NULL), pos(0) {}
+    File(std::vector<uint8_t> *data, size_t pos) : data(data), pos(pos) {}
+
+    size_t size() const { return data ? data->size() : 0; }
+
+    bool seek(uint32_t offset, SeekMode mode)
+    {
+        size_t to = mode == SeekSet ? offset : mode == SeekCur ? pos + offset : size() + offset;
+        if (!data || to > size()) {
+            return false;
+        }
+        pos = to;
+        return true;
+    }
+
+    size_t read(uint8_t *buf, size_t len)
+    {
+        size_t n = min(len, size() - pos);
+        if (n > 0) {
+            memcpy(buf, &(*data)[pos], n);
+        }
+        pos += n;
+        return n;
+    }
+
+    size_t write(const uint8_t *buf, size_t len)
+    {
+        if (!data) {
+            return 0;
+        }
+        data->resize(max(data->size(), pos + len));
+        memcpy(&(*data)[pos], buf, len);
+        pos += len;
+        return len;
+    }
+
+    void close() { data = NULL; }
+    operator bool() const { return data != NULL; }
+
+  private:
+    std::vector<uint8_t> *data;
+    size_t                pos;
+};
+
+class HostFS
+{
+  public:
+    bool begin() { return true; }
+
+    // "r" an existing file, "w" a truncated one, "a" at its end
+    File open(const char *path, const char *mode)
+    {
+        if (mode[0] == 'r') {
+            std::map<std::string, std::vector<uint8_t>>::iterator f = files.find(path);
+            return f == files.end() ? File() : File(&f->second, 0);
+        }
+        std::vector<uint8_t> &f = files[path];
+        if (mode[0] == 'w') {
+            f.clear();
+        }
+        return File(&f, mode[0] == 'a' ? f.size() : 0);
+    }
+
+    bool exists(const char *path) { return files.count(path) > 0; }
+    bool remove(const char *path) { return files.erase(path) > 0; }
+
+    bool rename(const char *from, const char *to)
+    {
+        std::map<std::string, std::vector<uint8_t>>::iterator f = files.find(from);
+        if (f == files.end()) {
+            return false;
+        }
+        files[to].swap(f->second);
+        files.erase(from);
+        return true;
+    }
+
+    std::map<std::string, std::vector<uint8_t>> files;
+};
+
+static HostFS LittleFS;
+
+#endif // BGE_TEST_LITTLEFS_H
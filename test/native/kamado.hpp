@@ -0,0 +1,50 @@
+#ifndef BGE_TEST_KAMADO_HPP
+#define BGE_TEST_KAMADO_HPP
+
+// A kamado for the control tests. The dome heads for ambient plus what
+// the fire gives at the fan duty, through a first-order lag after a dead
+// time; the meat warms through its surface, both first order as well.
+// The defaults are round figures for a medium ceramic grill, of the size
+// model.hpp identifies on one. The tests compare strategies on it; it
+// does not predict a real cook.
+
+#include <deque>
+
+class Kamado
+{
+  public:
+    Kamado(double start = 70, double meatStart = 40)
+        : dome(start), surface(meatStart), meat(meatStart), ambient(70), idle(120), gain(900), lag(600),
+          deadTime(30), surfaceLag(25 * 60), meatLag(3 * 3600)
+    {
+    }
+
+    // dt seconds with the fan at duty 0-1; keep dt the same all run, the
+    // dead time is counted in steps
+    void step(double duty, double dt)
+    {
+        delayed.push_back(duty);
+        double fire = 0;
+        if (delayed.size() > deadTime / dt) {
+            fire = delayed.front();
+            delayed.pop_front();
+        }
+        dome    += dt * (ambient + idle + gain * fire - dome) / lag;
+        surface += dt * (dome - surface) / surfaceLag;
+        meat    += dt * (surface - meat) / meatLag;
+    }
+
+    double dome, surface, meat; // F
+    double ambient;             // F
+    double idle;                // F above ambient with the fan off, the draft through the vents
+    double gain;                // F more at full fan
+    double lag;                 // s, dome time constant
+    double deadTime;            // s from fan to dome
+    double surfaceLag;          // s, dome to meat surface
+    double meatLag;             // s, surface to core
+
+  private:
+    std::deque<double> delayed;
+};
+
+#endif // BGE_TEST_KAMADO_HPP
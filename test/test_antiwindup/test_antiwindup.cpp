@@ -0,0 +1,145 @@
+// Overshoot and time in band on a simulated kamado, the stock PID_v1
+// against DomePid, over a 450, 225, 550, 350 F cook. domePID alone: no
+// feed-forward, no MPC. Prints the table.
+#include <unity.h>
+
+#include <stdio.h>
+
+#include "bgemonitor.hpp"
+#include "kamado.hpp"
+#include "thermocouple.hpp"
+
+// the modules under test are built into each suite, see [env:native]
+#include "domepid.cpp"
+
+#define QUANTUM 0.45 // F, one MAX6675 count
+#define BAND    10.0 // F either side of the setpoint
+
+static const double TARGETS[] = {450, 225, 550, 350};
+#define NLEGS    (sizeof(TARGETS) / sizeof(TARGETS[0]))
+#define LEGHOURS 2.0
+
+struct Result {
+    double overshoot[NLEGS]; // F past the setpoint, in the direction of the step
+    double inBand;           // share of the cook within BAND
+};
+
+// fan rate in % of the window per second, 0 for none; PID_v1 on every
+// 100 ms pass as the firmware ran it, DomePid once per fresh reading
+static Result run(bool stock, double kp, double ki, double kd, double rate)
+{
+    Kamado grill;
+    Result r     = {};
+    double input = grill.dome, output = 0, target = TARGETS[0];
+
+    PID     old(&input, &output, &target, kp, ki, kd, DIRECT);
+    DomePid now(&input, &output, &target, kp, ki, kd, DIRECT);
+    old.SetOutputLimits(0, FANWINDOW);
+    now.SetOutputLimits(0, FANWINDOW);
+    now.SetSampleTime(0);
+    now.SetDerivativeFilter(DERIVFILTER);
+    now.SetOutputRate(rate * FANWINDOW / 100);
+    if (stock) {
+        old.SetMode(AUTOMATIC);
+    } else {
+        now.SetMode(AUTOMATIC);
+    }
+
+    const unsigned long perLeg  = LEGHOURS * 3600000 / CONTROLINTERVAL;
+    const unsigned long perRead = KTCINTERVAL * KTC_DECIMATE / CONTROLINTERVAL;
+    const double        dt      = CONTROLINTERVAL / 1000.0;
+    unsigned long       inBand  = 0;
+    double              from    = grill.dome;
+    for (size_t leg = 0; leg < NLEGS; leg++) {
+        target     = TARGETS[leg];
+        double dir = target > from ? 1 : -1;
+        for (unsigned long pass = 0; pass < perLeg; pass++) {
+            hostAdvance(CONTROLINTERVAL);
+            grill.step(output / FANWINDOW, dt);
+            bool fresh = pass % perRead == 0;
+            if (fresh) {
+                input = floor(grill.dome / QUANTUM) * QUANTUM;
+            }
+            if (stock) {
+                old.Compute();
+            } else if (fresh) {
+                now.Compute();
+            }
+            r.overshoot[leg] = max(r.overshoot[leg], dir * (grill.dome - target));
+            inBand += fabs(grill.dome - target) <= BAND;
+        }
+        from = target;
+    }
+    r.inBand = 100.0 * inBand / (NLEGS * perLeg);
+    return r;
+}
+
+static void show(const char *name, const Result &r)
+{
+    printf("  %-28s", name);
+    for (size_t i = 0; i < NLEGS; i++) {
+        printf(" %6.1f", r.overshoot[i]);
+    }
+    printf(" %8.1f %%\n", r.inBand);
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void header(const char *gains)
+{
+    printf("gains %s, overshoot in F   ", gains);
+    for (size_t i = 0; i < NLEGS; i++) {
+        printf(" %6.0f", TARGETS[i]);
+    }
+    printf("  in %.0f F\n", BAND);
+}
+
+// the stock 4/0.2/1 fills the integral in the first two minutes, before
+// the fan saturates, so there is little windup to take out: DomePid is no
+// better here, and no worse
+static void test_stock_gains_match_pid_v1()
+{
+    Result old = run(true, 4, 0.2, 1, 0);
+    Result now = run(false, 4, 0.2, 1, 0);
+    header("4/0.2/1");
+    show("PID_v1", old);
+    show("DomePid", now);
+
+    TEST_ASSERT_TRUE(fabs(now.overshoot[0] - old.overshoot[0]) < 5);
+    TEST_ASSERT_TRUE(now.inBand > old.inBand - 1);
+}
+
+// gains that lean on the proportional term saturate the fan long enough
+// for anti-windup to matter, and the rate limit takes the rest
+static void test_tuned_gains_cut_the_overshoot()
+{
+    Result stock = run(true, 4, 0.2, 1, 0);
+    Result old   = run(true, 20, 0.05, 0, 0);
+    Result now   = run(false, 20, 0.05, 0, 0);
+    Result rated = run(false, 20, 0.05, 0, 1);
+    header("20/0.05/0");
+    show("PID_v1", old);
+    show("DomePid", now);
+    show("DomePid, 1 %/s", rated);
+
+    for (size_t i = 0; i < NLEGS; i++) {
+        TEST_ASSERT_TRUE(rated.overshoot[i] <= now.overshoot[i] + 0.5);
+    }
+    TEST_ASSERT_TRUE(rated.overshoot[0] < old.overshoot[0]);
+    TEST_ASSERT_TRUE(rated.overshoot[0] < stock.overshoot[0] / 4);
+    TEST_ASSERT_TRUE(rated.inBand > stock.inBand + 10);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_stock_gains_match_pid_v1);
+    RUN_TEST(test_tuned_gains_cut_the_overshoot);
+    return UNITY_END();
+}
@@ -0,0 +1,167 @@
+// The cascade on a simulated kamado: the outer loop should finish a cook
+// sooner than a fixed dome, never ask for more than the ceiling, and
+// bring the dome down so the meat runs on past its target far less.
+#include <unity.h>
+
+#include <stdio.h>
+
+#include "kamado.hpp"
+#include "logstub.hpp"
+
+// the modules under test are built into each suite, see [env:native]
+#include "cascade.cpp"
+#include "crc32.cpp"
+#include "domepid.cpp"
+
+// the firmware's controller state, owned by bgemonitor.cpp there
+double domeTarget, domeTempF, meatTarget, meatTempF;
+
+#define MEAT     203.0
+#define FLOOR    225.0 // F, the cascade's dome floor
+#define PULLED   3.0 // F under the target counts as done
+
+struct Cook {
+    double hours;      // until the meat is within PULLED of the target
+    double meatPeak;   // hottest the meat gets in the hour after that
+    double maxTarget;  // highest domeTarget asked for
+    double maxDome;    // hottest the dome gets once past the first hour
+};
+
+// A cook from a cold grill. The inner loop is domePID as bgemonitor sets
+// it up, computed once a second; meatTick runs the outer loop every
+// CASCADE_INTERVAL, give or take jitter ms. Without a ceiling the dome is
+// held at fixed throughout.
+static Cook cook(double fixed, double ceiling, long jitter = 0)
+{
+    Kamado  grill;
+    double  fan = 0;
+    DomePid dome(&domeTempF, &fan, &domeTarget, 4, 0.2, 1, DIRECT);
+    dome.SetOutputLimits(0, FANWINDOW);
+    dome.SetSampleTime(0);
+    dome.SetDerivativeFilter(DERIVFILTER);
+
+    domeTempF  = grill.dome;
+    meatTempF  = grill.meat;
+    domeTarget = ceiling > 0 ? FLOOR : fixed;
+    TEST_ASSERT_NULL(cascadeConfigure(ceiling > 0, MEAT, FLOOR, ceiling > 0 ? ceiling : 500));
+    dome.SetMode(AUTOMATIC);
+
+    Cook          c    = {-1, 0, 0, 0};
+    unsigned long next = CASCADE_INTERVAL;
+    for (unsigned long s = 1; s < 16 * 3600; s++) {
+        hostAdvance(1000);
+        dome.Compute();
+        grill.step(fan / FANWINDOW, 1);
+        domeTempF = grill.dome;
+        meatTempF = grill.meat;
+
+        if (s * 1000 >= next) {
+            cascadeUpdate();
+            // alternately early and late, as the scheduler lets it run
+            next += CASCADE_INTERVAL + (next / CASCADE_INTERVAL % 2 ? jitter : -jitter);
+        }
+
+        c.maxTarget = max(c.maxTarget, domeTarget);
+        if (s > 3600) {
+            c.maxDome = max(c.maxDome, grill.dome);
+        }
+        if (c.hours < 0 && grill.meat >= MEAT - PULLED) {
+            c.hours = s / 3600.0;
+        }
+        if (c.hours >= 0) {
+            c.meatPeak = max(c.meatPeak, grill.meat);
+            if (s / 3600.0 >= c.hours + 1) {
+                break;
+            }
+        }
+    }
+    return c;
+}
+
+static void print(const char *name, const Cook &c)
+{
+    printf("%-24s done %.2f h, meat peak %.1f F, target up to %.0f, dome up to %.0f\n", name, c.hours, c.meatPeak,
+           c.maxTarget, c.maxDome);
+}
+
+void setUp()
+{
+    // nothing in flash, so the defaults
+    cascadeBegin();
+}
+
+void tearDown()
+{
+}
+
+static void test_cascade_cooks_sooner_under_the_ceiling()
+{
+    Cook low    = cook(FLOOR, 0);
+    Cook fixed  = cook(450, 0);
+    Cook hot    = cook(500, 0);
+    Cook ranged = cook(0, 500);
+    print("fixed 225", low);
+    print("fixed 450", fixed);
+    print("fixed 500", hot);
+    print("cascade 225-500", ranged);
+
+    // sooner than a fixed dome short of the ceiling
+    TEST_ASSERT_TRUE(ranged.hours > 0 && fixed.hours > 0);
+    TEST_ASSERT_TRUE(ranged.hours < fixed.hours - 0.05);
+    TEST_ASSERT_TRUE(ranged.hours < low.hours / 3);
+
+    // never asks for more than the ceiling; the dome overshoots it no more
+    // than domePID does holding the ceiling outright
+    TEST_ASSERT_TRUE(ranged.maxTarget <= 500);
+    TEST_ASSERT_TRUE(ranged.maxDome <= hot.maxDome + 1);
+
+    // and the meat runs on far less than at either fixed dome
+    TEST_ASSERT_TRUE(ranged.meatPeak < fixed.meatPeak - 30);
+    TEST_ASSERT_TRUE(ranged.meatPeak < hot.meatPeak - 30);
+}
+
+// a pass a little early must still run, and the integral must count the
+// time that actually passed
+static void test_outer_loop_runs_on_every_pass()
+{
+    Cook steady   = cook(0, 500);
+    Cook jittered = cook(0, 500, 200);
+    print("cascade, on time", steady);
+    print("cascade, 200 ms jitter", jittered);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.02, steady.hours, jittered.hours);
+    TEST_ASSERT_FLOAT_WITHIN(1, steady.meatPeak, jittered.meatPeak);
+
+    // PID_v1 with a 5 s sample time would skip the second pass
+    domeTarget = 400;
+    TEST_ASSERT_NULL(cascadeConfigure(true, MEAT, FLOOR, 500));
+    meatTempF = MEAT - 20;
+    for (int i = 0; i < 2; i++) {
+        hostAdvance(CASCADE_INTERVAL);
+        cascadeUpdate();
+    }
+    double before = domeTarget;
+    hostAdvance(CASCADE_INTERVAL - 200);
+    meatTempF = MEAT - 10;
+    cascadeUpdate();
+    TEST_ASSERT_TRUE(domeTarget < before);
+}
+
+static void test_missing_probe_holds_the_dome()
+{
+    TEST_ASSERT_NULL(cascadeConfigure(true, MEAT, FLOOR, 500));
+    domeTarget = 300;
+    meatTempF  = NAN;
+    hostAdvance(CASCADE_INTERVAL);
+    cascadeUpdate();
+    TEST_ASSERT_EQUAL_FLOAT(300, domeTarget);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_cascade_cooks_sooner_under_the_ceiling);
+    RUN_TEST(test_outer_loop_runs_on_every_pass);
+    RUN_TEST(test_missing_probe_holds_the_dome);
+    return UNITY_END();
+}
@@ -0,0 +1,249 @@
+// Cook log recovery on a simulated flash that can lose power part way
+// through a write.
+#include <unity.h>
+
+#include <vector>
+
+// the modules under test are built into each suite, see [env:native]
+#include "cooklog.cpp"
+#include "crc32.cpp"
+
+// both logs as byte vectors; a power cut lets an append write its first
+// cutAt bytes and then fails it, like LittleFS losing power before close
+class FakeFlash : public CookLogStorage
+{
+  public:
+    FakeFlash() : cutAt(-1), failing(false), rotations(0) {}
+
+    size_t size(bool previous) { return log(previous).size(); }
+
+    bool read(bool previous, size_t offset, uint8_t *buf, size_t len)
+    {
+        std::vector<uint8_t> &v = log(previous);
+        if (offset + len > v.size()) {
+            return false;
+        }
+        memcpy(buf, &v[offset], len);
+        return true;
+    }
+
+    bool append(const uint8_t *buf, size_t len)
+    {
+        if (failing) {
+            return false;
+        }
+        if (cutAt >= 0) {
+            current.insert(current.end(), buf, buf + min((size_t) cutAt, len));
+            cutAt = -1;
+            return false;
+        }
+        current.insert(current.end(), buf, buf + len);
+        return true;
+    }
+
+    bool rotate()
+    {
+        previous.swap(current);
+        current.clear();
+        rotations++;
+        return true;
+    }
+
+    bool clear()
+    {
+        current.clear();
+        previous.clear();
+        return true;
+    }
+
+    std::vector<uint8_t> current, previous;
+    int                  cutAt;
+    bool                 failing;
+    int                  rotations;
+
+  private:
+    std::vector<uint8_t> &log(bool previous) { return previous ? this->previous : current; }
+};
+
+static const uint8_t PAGERECORDS = COOKLOG_PAGE / sizeof(CookRecord);
+
+static void appendRecords(CookLog &log, int count, float first)
+{
+    for (int i = 0; i < count; i++) {
+        CookRecord r = {};
+        r.setpoint   = first + i;
+        r.mode       = 1;
+        log.append(r);
+    }
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_empty_log_recovers_nothing()
+{
+    FakeFlash flash;
+    CookLog   log(flash);
+    CookRecord r;
+
+    TEST_ASSERT_FALSE(log.recover(r));
+}
+
+static void test_recovers_newest_record()
+{
+    FakeFlash flash;
+    CookLog   log(flash);
+    CookRecord r;
+
+    appendRecords(log, 20, 100);
+    TEST_ASSERT_TRUE(log.flush());
+    TEST_ASSERT_EQUAL_UINT32(3, log.written());
+
+    CookLog after(flash);
+    TEST_ASSERT_TRUE(after.recover(r));
+    TEST_ASSERT_EQUAL_UINT32(19, r.seq);
+    TEST_ASSERT_EQUAL_FLOAT(119, r.setpoint);
+    TEST_ASSERT_EQUAL_UINT8(1, r.mode);
+
+    // numbering carries on from the recovered record
+    appendRecords(after, 1, 500);
+    TEST_ASSERT_TRUE(after.flush());
+    CookLog again(flash);
+    TEST_ASSERT_TRUE(again.recover(r));
+    TEST_ASSERT_EQUAL_UINT32(20, r.seq);
+}
+
+// power dies at every byte of a page write in turn; whatever made it to
+// flash whole is recovered, the torn record never is
+static void test_power_cut_at_every_offset()
+{
+    for (int cut = 0; cut <= COOKLOG_PAGE; cut++) {
+        FakeFlash flash;
+        CookLog   log(flash);
+        CookRecord r;
+
+        appendRecords(log, PAGERECORDS, 0);
+        flash.cutAt = cut;
+        appendRecords(log, PAGERECORDS, 1000);
+
+        CookLog after(flash);
+        TEST_ASSERT_TRUE(after.recover(r));
+        uint32_t whole = cut / sizeof(CookRecord);
+        uint32_t seq   = whole > 0 ? PAGERECORDS + whole - 1 : PAGERECORDS - 1;
+        TEST_ASSERT_EQUAL_UINT32(seq, r.seq);
+        TEST_ASSERT_EQUAL_FLOAT(whole > 0 ? 1000 + whole - 1 : PAGERECORDS - 1, r.setpoint);
+    }
+}
+
+// the first flush after a torn write starts a fresh, aligned log, so the
+// records written after the reboot are found rather than misread
+static void test_log_realigns_after_torn_write()
+{
+    FakeFlash flash;
+    CookLog   log(flash);
+    CookRecord r;
+
+    appendRecords(log, PAGERECORDS, 0);
+    flash.cutAt = 100;
+    appendRecords(log, PAGERECORDS, 1000);
+    TEST_ASSERT_NOT_EQUAL(0, flash.current.size() % sizeof(CookRecord));
+
+    CookLog after(flash);
+    TEST_ASSERT_TRUE(after.recover(r));
+    appendRecords(after, 3, 2000);
+    TEST_ASSERT_TRUE(after.flush());
+    TEST_ASSERT_EQUAL_INT(1, flash.rotations);
+    TEST_ASSERT_EQUAL(3 * sizeof(CookRecord), flash.current.size());
+
+    CookLog again(flash);
+    TEST_ASSERT_TRUE(again.recover(r));
+    TEST_ASSERT_EQUAL_FLOAT(2002, r.setpoint);
+    TEST_ASSERT_EQUAL_UINT32(r.seq, PAGERECORDS + 3 + 2);
+}
+
+// a record damaged after it was written is skipped for the one before it
+static void test_corrupt_record_falls_back()
+{
+    FakeFlash flash;
+    CookLog   log(flash);
+    CookRecord r;
+
+    appendRecords(log, PAGERECORDS, 0);
+    flash.current[flash.current.size() - 10] ^= 0x40;
+
+    CookLog after(flash);
+    TEST_ASSERT_TRUE(after.recover(r));
+    TEST_ASSERT_EQUAL_UINT32(PAGERECORDS - 2, r.seq);
+}
+
+// power dies on the first write after a rotation: the new log holds only
+// a torn record, so recovery falls back to the rotated one
+static void test_cut_after_rotation_uses_previous_log()
+{
+    FakeFlash flash;
+    CookLog   log(flash);
+    CookRecord r;
+
+    int full = COOKLOG_MAXSIZE / sizeof(CookRecord);
+    appendRecords(log, full, 0);
+    TEST_ASSERT_EQUAL_INT(0, flash.rotations);
+    flash.cutAt = 20;
+    appendRecords(log, PAGERECORDS, 90000);
+    TEST_ASSERT_EQUAL_INT(1, flash.rotations);
+    TEST_ASSERT_EQUAL(20, flash.current.size());
+
+    CookLog after(flash);
+    TEST_ASSERT_TRUE(after.recover(r));
+    TEST_ASSERT_EQUAL_UINT32(full - 1, r.seq);
+}
+
+// with the flash refusing writes, the newest records are kept in RAM and
+// all go out once it recovers
+static void test_failed_writes_keep_newest_records()
+{
+    FakeFlash flash;
+    CookLog   log(flash);
+    CookRecord r;
+
+    flash.failing = true;
+    appendRecords(log, 3 * PAGERECORDS, 0);
+    TEST_ASSERT_EQUAL_UINT8(PAGERECORDS, log.pending());
+    TEST_ASSERT_EQUAL(0, flash.current.size());
+
+    flash.failing = false;
+    TEST_ASSERT_TRUE(log.flush());
+    CookLog after(flash);
+    TEST_ASSERT_TRUE(after.recover(r));
+    TEST_ASSERT_EQUAL_UINT32(3 * PAGERECORDS - 1, r.seq);
+    TEST_ASSERT_EQUAL(COOKLOG_PAGE, flash.current.size());
+}
+
+static void test_clear_forgets_the_cook()
+{
+    FakeFlash flash;
+    CookLog   log(flash);
+    CookRecord r;
+
+    appendRecords(log, 2 * PAGERECORDS, 0);
+    log.clear();
+    TEST_ASSERT_FALSE(CookLog(flash).recover(r));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_log_recovers_nothing);
+    RUN_TEST(test_recovers_newest_record);
+    RUN_TEST(test_power_cut_at_every_offset);
+    RUN_TEST(test_log_realigns_after_torn_write);
+    RUN_TEST(test_corrupt_record_falls_back);
+    RUN_TEST(test_cut_after_rotation_uses_previous_log);
+    RUN_TEST(test_failed_writes_keep_newest_records);
+    RUN_TEST(test_clear_forgets_the_cook);
+    return UNITY_END();
+}
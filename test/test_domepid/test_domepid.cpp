@@ -0,0 +1,158 @@
+// Fan output noise from the dome PID on a steady fire. One dome trace is
+// fed, open loop, to the controller as it was (PID_v1 on every 100 ms
+// pass) and as it is (DomePid once per fresh reading, with and without
+// the derivative filter). Prints the table.
+//
+// The trace is synthetic unless BGE_DOME_TRACE names a capture: one dome
+// reading in F per line, a reading every KTCINTERVAL ms.
+#include <unity.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+
+#include "bgemonitor.hpp"
+#include "kamado.hpp"
+
+// the modules under test are built into each suite, see [env:native]
+#include "domepid.cpp"
+
+#define NOISE   0.5  // F rms at the thermocouple
+#define QUANTUM 0.45 // F, one MAX6675 count
+#define SMOOTH  50   // passes each side of the moving average, 5 s
+
+// a fire holding near 450 with the fan wandering slowly, read every
+// KTCINTERVAL ms; the noise comes from a fixed-seed generator so every
+// run sees the same trace
+static std::vector<double> synthetic()
+{
+    Kamado              grill(440);
+    std::vector<double> trace;
+    uint32_t            seed = 7;
+    const double        dt   = KTCINTERVAL / 1000.0;
+    for (int i = 0; i < 3 * 3600 / dt; i++) {
+        grill.step(0.29 + 0.05 * sin(i * dt / 300), dt);
+        // Box-Muller on a 32-bit xorshift
+        double u[2];
+        for (int k = 0; k < 2; k++) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            u[k] = (seed + 1.0) / 4294967297.0;
+        }
+        double noise = NOISE * sqrt(-2 * log(u[0])) * cos(2 * M_PI * u[1]);
+        trace.push_back(floor((grill.dome + noise) / QUANTUM) * QUANTUM);
+    }
+    return trace;
+}
+
+static std::vector<double> load(const char *path)
+{
+    std::vector<double> trace;
+    FILE               *f = fopen(path, "r");
+    TEST_ASSERT_NOT_NULL(f);
+    double v;
+    while (fscanf(f, "%lf", &v) == 1) {
+        trace.push_back(v);
+    }
+    fclose(f);
+    return trace;
+}
+
+static const std::vector<double> &trace()
+{
+    static std::vector<double> t = getenv("BGE_DOME_TRACE") ? load(getenv("BGE_DOME_TRACE")) : synthetic();
+    return t;
+}
+
+// rms of the output about its moving average, in ms of fan per window
+static double noise(const std::vector<double> &out)
+{
+    double sum = 0, window = 0;
+    size_t n   = 0;
+    for (size_t i = 0; i < 2 * SMOOTH + 1 && i < out.size(); i++) {
+        window += out[i];
+    }
+    for (size_t i = SMOOTH; i + SMOOTH + 1 < out.size(); i++) {
+        double d = out[i] - window / (2 * SMOOTH + 1);
+        sum     += d * d;
+        n++;
+        window += out[i + SMOOTH + 1] - out[i - SMOOTH];
+    }
+    return sqrt(sum / n);
+}
+
+enum Setup { OLD, FRESH, FILTERED };
+
+// controlTick's passes over the trace, the output sampled every pass
+static double run(Setup setup, double kp, double ki, double kd)
+{
+    const std::vector<double> &t   = trace();
+    double                     in  = t[0], out = FANWINDOW * 0.29, sp = 450;
+    std::vector<double>        outs;
+
+    PID     old(&in, &out, &sp, kp, ki, kd, DIRECT);
+    DomePid now(&in, &out, &sp, kp, ki, kd, DIRECT);
+    old.SetOutputLimits(0, FANWINDOW);
+    now.SetOutputLimits(0, FANWINDOW);
+    now.SetSampleTime(0);
+    now.SetDerivativeFilter(setup == FILTERED ? DERIVFILTER : 0);
+    if (setup == OLD) {
+        old.SetMode(AUTOMATIC);
+    } else {
+        now.SetMode(AUTOMATIC);
+    }
+
+    const unsigned long passes = t.size() * KTCINTERVAL / CONTROLINTERVAL;
+    unsigned long       shown  = 0;
+    for (unsigned long pass = 0; pass < passes; pass++) {
+        hostAdvance(CONTROLINTERVAL);
+        unsigned long reading = pass * CONTROLINTERVAL / KTCINTERVAL;
+        bool          fresh   = reading != shown || pass == 0;
+        shown                 = reading;
+        in                    = t[reading];
+        if (setup == OLD) {
+            old.Compute();
+        } else if (fresh) {
+            now.Compute();
+        }
+        outs.push_back(out);
+    }
+    return noise(outs);
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_fresh_reads_and_filter_quiet_the_fan()
+{
+    const double gains[][3] = {{4, 0.2, 1}, {30, 0.05, 100}};
+    printf("%d readings, %s\n", (int) trace().size(), getenv("BGE_DOME_TRACE") ? "captured" : "synthetic");
+    for (size_t g = 0; g < 2; g++) {
+        const double *k        = gains[g];
+        double        old      = run(OLD, k[0], k[1], k[2]);
+        double        fresh    = run(FRESH, k[0], k[1], k[2]);
+        double        filtered = run(FILTERED, k[0], k[1], k[2]);
+        printf("gains %g/%g/%g, fan noise in ms per window\n", k[0], k[1], k[2]);
+        printf("  PID_v1, every 100 ms pass          %7.1f\n", old);
+        printf("  DomePid, fresh reads               %7.1f\n", fresh);
+        printf("  DomePid, fresh reads + 2 s filter  %7.1f\n", filtered);
+
+        TEST_ASSERT_TRUE(fresh < old);
+        TEST_ASSERT_TRUE(filtered < fresh);
+        TEST_ASSERT_TRUE(filtered < old / 2);
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fresh_reads_and_filter_quiet_the_fan);
+    return UNITY_END();
+}
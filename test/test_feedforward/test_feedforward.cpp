@@ -0,0 +1,146 @@
+// The dome loop on a simulated kamado, domePID alone against domePID
+// with the model's feed-forward, over setpoint steps and a change in how
+// hard the fire answers the fan. Prints the settle-time table.
+#include <unity.h>
+
+#include <stdio.h>
+
+#include <vector>
+
+#include "kamado.hpp"
+#include "thermocouple.hpp"
+
+// the modules under test are built into each suite, see [env:native]
+#include "domeloop.cpp"
+#include "domepid.cpp"
+#include "model.cpp"
+#include "mpc.cpp"
+
+// the firmware's controller state, owned by bgemonitor.cpp there
+double  domeTarget, domeTempF, fanOutput, pidOutput, domeReference;
+DomePid domePID(&domeTempF, &pidOutput, &domeReference, 4, 0.2, 1, DIRECT);
+
+double probeSafeOutput()
+{
+    return 0;
+}
+
+#define SETTLED 5.0 // F either side of the setpoint
+
+// from this many hours into the run, with the plant's gain
+struct Leg {
+    const char *name;
+    double      hours;
+    double      target;
+    double      gain;
+};
+
+static const Leg LEGS[] = {
+    {"warm-up 70->450", 0, 450, 900},
+    {"step 450->550", 2, 550, 900},
+    {"step 550->350", 3.5, 350, 900},
+    {"step 350->450", 5, 450, 900},
+    {"gain 900->600", 6.5, 450, 600},
+    {"step 450->300 (K 600)", 8, 300, 600},
+};
+#define NLEGS (sizeof(LEGS) / sizeof(LEGS[0]))
+#define RUNHOURS 9.5
+
+struct Result {
+    double settle[NLEGS];    // s until the dome stays within SETTLED
+    double overshoot[NLEGS]; // F past the setpoint, in the direction of the step
+};
+
+// controlTick's pass every CONTROLINTERVAL ms, with a fresh reading
+// every KTC_DECIMATE samples as the filter hands them on
+static Result run(bool feedForward)
+{
+    Kamado grill;
+    Result r = {};
+
+    domeModel.reset();
+    feedForwardEnabled = feedForward;
+    domeTarget         = LEGS[0].target;
+    domeTempF          = grill.dome;
+    fanOutput          = 0;
+    domePID.SetMode(MANUAL);
+    domePID.SetTunings(4, 0.2, 1);
+    domePID.SetOutputLimits(0, FANWINDOW);
+    domePID.SetSampleTime(0);
+    domePID.SetDerivativeFilter(DERIVFILTER);
+    domeAutomatic();
+
+    const unsigned long passes  = RUNHOURS * 3600000 / CONTROLINTERVAL;
+    const unsigned long perRead = KTCINTERVAL * KTC_DECIMATE / CONTROLINTERVAL;
+    size_t              leg     = 0;
+    unsigned long       start = 0, settled = 0;
+    double              from = grill.dome;
+    for (unsigned long pass = 0; pass < passes; pass++) {
+        if (leg + 1 < NLEGS && pass * CONTROLINTERVAL >= LEGS[leg + 1].hours * 3600000) {
+            r.settle[leg] = (settled - start) * CONTROLINTERVAL / 1000.0;
+            from          = domeTarget;
+            leg++;
+            domeTarget = LEGS[leg].target;
+            grill.gain = LEGS[leg].gain;
+            start = settled = pass;
+        }
+
+        hostAdvance(CONTROLINTERVAL);
+        grill.step(fanOutput / FANWINDOW, CONTROLINTERVAL / 1000.0);
+        bool fresh = pass % perRead == 0;
+        if (fresh) {
+            domeTempF = grill.dome;
+        }
+        domeControl(fresh, false, CONTROLINTERVAL / 1000.0);
+
+        double error = grill.dome - domeTarget;
+        if (fabs(error) > SETTLED) {
+            settled = pass + 1;
+        }
+        r.overshoot[leg] = max(r.overshoot[leg], domeTarget >= from ? error : -error);
+    }
+    r.settle[leg] = (settled - start) * CONTROLINTERVAL / 1000.0;
+    return r;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_feedforward_settles_steps_sooner()
+{
+    Result pid = run(false);
+    Result ff  = run(true);
+
+    printf("%-22s %18s %22s\n", "", "PID only", "PID + feed-forward");
+    for (size_t i = 0; i < NLEGS; i++) {
+        printf("%-22s %6.0f s / %5.1f F %10.0f s / %5.1f F\n", LEGS[i].name, pid.settle[i], pid.overshoot[i],
+               ff.settle[i], ff.overshoot[i]);
+    }
+    printf("model: gain %.0f F, tau %.0f s, ambient %.0f F, trusted %d\n", domeModel.gain(), domeModel.timeConstant(),
+           domeModel.ambient(), domeModel.trusted());
+
+    // the warm-up is mostly over before the model is trusted
+    TEST_ASSERT_TRUE(ff.settle[0] <= pid.settle[0]);
+    // setpoint steps on the plant the model has learned settle in well
+    // under half the time, with a fraction of the overshoot
+    for (size_t i = 1; i <= 3; i++) {
+        TEST_ASSERT_TRUE(ff.settle[i] < pid.settle[i] / 2);
+        TEST_ASSERT_TRUE(ff.overshoot[i] < pid.overshoot[i] / 4);
+    }
+    // a plant change is the PID's to answer until the model catches up
+    TEST_ASSERT_TRUE(ff.settle[4] < pid.settle[4] * 1.1);
+    TEST_ASSERT_TRUE(ff.settle[5] < pid.settle[5]);
+    TEST_ASSERT_TRUE(domeModel.trusted());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_feedforward_settles_steps_sooner);
+    return UNITY_END();
+}
@@ -0,0 +1,119 @@
+// Fixed-point temperatures: fmtFixed() against printf for every reading
+// an int16 can carry, and what the integer path costs next to the
+// double and printf one it replaced. Prints the timings.
+#include <unity.h>
+
+#include <stdio.h>
+
+// the modules under test are built into each suite, see [env:native]
+#include "fixed.cpp"
+#include "telemetry.hpp"
+
+// v / 16 rounded half away from zero, through printf; printf itself
+// rounds the binary value half to even, and writes -0
+static void reference(char *buf, size_t len, int32_t v, int decimals)
+{
+    double p = pow(10, decimals);
+    double x = v / 16.0;
+    double r = (x >= 0 ? floor(x * p + 0.5) : -floor(-x * p + 0.5)) / p;
+    snprintf(buf, len, "%.*f", decimals, r == 0 ? 0.0 : r);
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_fmt_fixed_matches_printf()
+{
+    char got[16], want[16];
+    for (int d = 0; d <= 3; d++) {
+        for (int32_t v = INT16_MIN + 1; v <= INT16_MAX; v++) {
+            size_t n = fmtFixed(got, sizeof(got), v, TEMP_SHIFT, d);
+            reference(want, sizeof(want), v, d);
+            TEST_ASSERT_EQUAL_STRING(want, got);
+            TEST_ASSERT_EQUAL(strlen(want), n);
+        }
+    }
+}
+
+static void test_fmt_decimal_matches_printf()
+{
+    char got[16], want[16];
+    for (int32_t v = -100000; v <= 100000; v += 7) {
+        fmtDecimal(got, sizeof(got), v, 2);
+        snprintf(want, sizeof(want), "%s%d.%02d", v < 0 ? "-" : "", abs(v) / 100, abs(v) % 100);
+        TEST_ASSERT_EQUAL_STRING(want, got);
+    }
+}
+
+// like snprintf: cut to fit, terminated, the full length returned
+static void test_fmt_truncates_like_snprintf()
+{
+    char small[5];
+    TEST_ASSERT_EQUAL(5, fmtFixed(small, sizeof(small), 7205, TEMP_SHIFT, 1));
+    TEST_ASSERT_EQUAL_STRING("450.", small);
+    TEST_ASSERT_EQUAL(6, fmtFixed(small, sizeof(small), -7205, TEMP_SHIFT, 1));
+    TEST_ASSERT_EQUAL_STRING("-450", small);
+}
+
+static void test_conversions_round_trip()
+{
+    for (int32_t v = INT16_MIN + 1; v <= INT16_MAX; v++) {
+        TEST_ASSERT_EQUAL_INT16(v, tempFromF(tempToF(v)));
+    }
+    TEST_ASSERT_EQUAL_INT16(TEMP_NONE, tempFromF(tempToF(TEMP_NONE)));
+    TEST_ASSERT_EQUAL_INT16(INT16_MAX, tempFromF(1e6));
+}
+
+// the ring and every sink's batch are sized by it
+static void test_telemetry_sample_stays_small()
+{
+    TEST_ASSERT_EQUAL(24, sizeof(TelemetrySample));
+}
+
+// ESP.getCycleCount() is the host's nanosecond clock here, so these read
+// in ns; GET /api/bench runs the same cases on the device in cycles
+static void bench_formatting()
+{
+    const int        runs = 1000000;
+    char             buf[16];
+    volatile int32_t sink = 0;
+
+    uint32_t start = ESP.getCycleCount();
+    for (int i = 0; i < runs; i++) {
+        sink = sink + fmtFixed(buf, sizeof(buf), 7200 + (i & 1023), TEMP_SHIFT, 1);
+    }
+    double fixed = (double) (ESP.getCycleCount() - start) / runs;
+
+    start = ESP.getCycleCount();
+    for (int i = 0; i < runs; i++) {
+        sink = sink + snprintf(buf, sizeof(buf), "%.1f", 450.0 + (i & 1023) * 0.0625);
+    }
+    double printed = (double) (ESP.getCycleCount() - start) / runs;
+
+    start = ESP.getCycleCount();
+    for (int i = 0; i < runs; i++) {
+        sink = sink + roundShift((int32_t) (7200 + (i & 1023)) * 10, TEMP_SHIFT);
+    }
+    double tenths = (double) (ESP.getCycleCount() - start) / runs;
+
+    printf("fmtFixed 1 decimal    %6.1f ns\n", fixed);
+    printf("snprintf \"%%.1f\"       %6.1f ns\n", printed);
+    printf("roundShift to tenths  %6.1f ns\n", tenths);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fmt_fixed_matches_printf);
+    RUN_TEST(test_fmt_decimal_matches_printf);
+    RUN_TEST(test_fmt_truncates_like_snprintf);
+    RUN_TEST(test_conversions_round_trip);
+    RUN_TEST(test_telemetry_sample_stays_small);
+    RUN_TEST(bench_formatting);
+    return UNITY_END();
+}
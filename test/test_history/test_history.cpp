@@ -0,0 +1,112 @@
+// The tiered cook history: that it fits its budget, gives a lid opening
+// back exactly instead of smearing it, and holds a whole day.
+#include <unity.h>
+
+#include <vector>
+
+// the modules under test are built into each suite, see [env:native]
+#include "history.cpp"
+
+struct Read {
+    std::vector<HistoryPoint> points;
+};
+
+static bool collect(void *ctx, const HistoryPoint &point)
+{
+    ((Read *) ctx)->points.push_back(point);
+    return true;
+}
+
+static std::vector<HistoryPoint> readTier(const History &h, uint8_t tier)
+{
+    Read r;
+    h.read(tier, 0, collect, &r);
+    return r.points;
+}
+
+// 1/2 F history steps to the 1/16 F the probes give
+static int16_t temp(int halfF)
+{
+    return halfF * (TEMP_SCALE / HISTORY_TEMP_SCALE);
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_fits_its_budget()
+{
+    printf("history: %u bytes\n", (unsigned) sizeof(History));
+    TEST_ASSERT_TRUE(sizeof(History) <= HISTORY_BUDGET);
+}
+
+// the dome falls 150 F in a second and climbs back, twice over the ring
+static void test_steps_come_back_exactly()
+{
+    static History h;
+    std::vector<int> dome;
+    for (uint32_t s = 1; s <= 2 * 300; s++) {
+        int d = s % 100 < 10 ? 600 : 900; // 300 or 450 F
+        dome.push_back(d);
+        h.add(s, temp(d), temp(300), 2500);
+    }
+
+    std::vector<HistoryPoint> p = readTier(h, 0);
+    TEST_ASSERT_EQUAL(300, p.size());
+    for (size_t i = 0; i < p.size(); i++) {
+        TEST_ASSERT_EQUAL_INT16(dome[dome.size() - p.size() + i], p[i].value[HISTORY_DOME]);
+        TEST_ASSERT_EQUAL_INT16(300, p[i].value[HISTORY_MEAT]);
+        TEST_ASSERT_EQUAL_INT16(25, p[i].value[HISTORY_FAN]);
+    }
+}
+
+// more large steps than the escape ring holds spread instead, and the
+// reconstruction still ends on the true value
+static void test_escape_overflow_spreads()
+{
+    static History h;
+    for (uint32_t s = 1; s <= 2 * HISTORY_ESCAPES + 20; s++) {
+        int d = s <= 2 * HISTORY_ESCAPES && s % 2 ? 600 : 900;
+        h.add(s, temp(d), TEMP_NONE, 0);
+    }
+    std::vector<HistoryPoint> p = readTier(h, 0);
+    TEST_ASSERT_EQUAL_INT16(900, p.back().value[HISTORY_DOME]);
+    TEST_ASSERT_FALSE(p.back().valid & (1 << HISTORY_MEAT));
+}
+
+// a day fills tier 2 with the means, gaps and all
+static void test_a_day_in_tier_two()
+{
+    static History h;
+    for (uint32_t s = 1; s <= 24 * 3600; s++) {
+        if (s / 3600 != 5) {
+            h.add(s, temp(900), temp(400), 3000);
+        }
+    }
+    std::vector<HistoryPoint> p = readTier(h, 2);
+    TEST_ASSERT_EQUAL(288, p.size());
+    TEST_ASSERT_EQUAL_UINT32(24 * 3600, p.back().time);
+    int gaps = 0;
+    for (size_t i = 0; i < p.size(); i++) {
+        if (!(p[i].valid & (1 << HISTORY_DOME))) {
+            gaps++;
+        } else {
+            TEST_ASSERT_EQUAL_INT16(900, p[i].value[HISTORY_DOME]);
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(11, gaps); // the hour without readings, less the two intervals it shares
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fits_its_budget);
+    RUN_TEST(test_steps_come_back_exactly);
+    RUN_TEST(test_escape_overflow_spreads);
+    RUN_TEST(test_a_day_in_tier_two);
+    return UNITY_END();
+}
@@ -0,0 +1,167 @@
+// The MPC on a simulated kamado next to domePID with and without the
+// feed-forward, over the feed-forward suite's scenario, and its
+// tolerance of a dead time the model does not expect. Prints the table.
+#include <unity.h>
+
+#include <stdio.h>
+
+#include <chrono>
+
+#include "kamado.hpp"
+#include "thermocouple.hpp"
+
+// the modules under test are built into each suite, see [env:native]
+#include "domeloop.cpp"
+#include "domepid.cpp"
+#include "model.cpp"
+#include "mpc.cpp"
+
+// the firmware's controller state, owned by bgemonitor.cpp there
+double  domeTarget, domeTempF, fanOutput, pidOutput, domeReference;
+DomePid domePID(&domeTempF, &pidOutput, &domeReference, 4, 0.2, 1, DIRECT);
+
+double probeSafeOutput()
+{
+    return 0;
+}
+
+#define SETTLED 5.0  // F either side of the setpoint
+#define QUANTUM 0.45 // F, one MAX6675 count
+
+enum Controller { PID_ONLY, FEEDFORWARD, MPC };
+
+struct Leg {
+    const char *name;
+    double      hours;
+    double      target;
+    double      gain;
+};
+
+static const Leg LEGS[] = {
+    {"warm-up 70->450", 0, 450, 900},
+    {"step 450->550", 2, 550, 900},
+    {"step 550->350", 3.5, 350, 900},
+    {"step 350->450", 5, 450, 900},
+    {"gain 900->600", 6.5, 450, 600},
+    {"step 450->300 (K 600)", 8, 300, 600},
+};
+#define NLEGS (sizeof(LEGS) / sizeof(LEGS[0]))
+#define RUNHOURS 9.5
+
+struct Result {
+    double settle[NLEGS]; // s until the dome stays within SETTLED
+    double iae;           // F h of tracking error after the warm-up
+    double travel;        // fan windows of duty moved, a measure of wear and noise
+    double perWindow;     // us of control passes per fan window, on this host
+};
+
+static Result run(Controller controller, double deadTime = 30)
+{
+    Kamado grill;
+    Result r = {};
+
+    grill.deadTime = deadTime;
+    domeModel.reset();
+    feedForwardEnabled = controller == FEEDFORWARD;
+    mpcEnabled         = controller == MPC;
+    domeTarget         = LEGS[0].target;
+    domeTempF          = grill.dome;
+    fanOutput          = 0;
+    domePID.SetMode(MANUAL);
+    domePID.SetTunings(4, 0.2, 1);
+    domePID.SetOutputLimits(0, FANWINDOW);
+    domePID.SetSampleTime(0);
+    domePID.SetDerivativeFilter(DERIVFILTER);
+    domeAutomatic();
+
+    const unsigned long passes  = RUNHOURS * 3600000 / CONTROLINTERVAL;
+    const unsigned long perRead = KTCINTERVAL * KTC_DECIMATE / CONTROLINTERVAL;
+    const double        dt      = CONTROLINTERVAL / 1000.0;
+    size_t              leg     = 0;
+    unsigned long       start = 0, settled = 0;
+    for (unsigned long pass = 0; pass < passes; pass++) {
+        if (leg + 1 < NLEGS && pass * CONTROLINTERVAL >= LEGS[leg + 1].hours * 3600000) {
+            r.settle[leg] = (settled - start) * dt;
+            leg++;
+            domeTarget = LEGS[leg].target;
+            grill.gain = LEGS[leg].gain;
+            start = settled = pass;
+        }
+
+        hostAdvance(CONTROLINTERVAL);
+        grill.step(fanOutput / FANWINDOW, dt);
+        bool fresh = pass % perRead == 0;
+        if (fresh) {
+            domeTempF = floor(grill.dome / QUANTUM) * QUANTUM;
+        }
+        double before = fanOutput;
+
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        domeControl(fresh, false, dt);
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+        r.perWindow += us;
+
+        double error = grill.dome - domeTarget;
+        if (fabs(error) > SETTLED) {
+            settled = pass + 1;
+        }
+        if (leg > 0) {
+            r.iae += fabs(error) * dt / 3600;
+        }
+        r.travel += fabs(fanOutput - before) / FANWINDOW;
+    }
+    r.settle[leg] = (settled - start) * dt;
+    r.perWindow /= passes * CONTROLINTERVAL / FANWINDOW;
+    return r;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_mpc_tracks_closest()
+{
+    Result pid = run(PID_ONLY);
+    Result ff  = run(FEEDFORWARD);
+    Result mpc = run(MPC);
+
+    printf("%-22s %10s %10s %10s\n", "settle to +-5 F", "PID", "PID + FF", "MPC");
+    for (size_t i = 0; i < NLEGS; i++) {
+        printf("%-22s %8.0f s %8.0f s %8.0f s\n", LEGS[i].name, pid.settle[i], ff.settle[i], mpc.settle[i]);
+    }
+    printf("%-22s %6.0f F h %6.0f F h %6.0f F h\n", "IAE after warm-up", pid.iae, ff.iae, mpc.iae);
+    printf("%-22s %10.1f %10.1f %10.1f\n", "fan travel, windows", pid.travel, ff.travel, mpc.travel);
+    printf("%-22s %8.1f us %7.1f us %7.1f us\n", "host time per window", pid.perWindow, ff.perWindow, mpc.perWindow);
+
+    TEST_ASSERT_TRUE(mpc.iae < ff.iae);
+    TEST_ASSERT_TRUE(ff.iae < pid.iae);
+    for (size_t i = 1; i < NLEGS; i++) {
+        TEST_ASSERT_TRUE(mpc.settle[i] < pid.settle[i]);
+    }
+    // the move weight keeps the fan from working harder than the PID's
+    TEST_ASSERT_TRUE(mpc.travel < pid.travel);
+}
+
+// the model assumes 30 s; the MPC stays ahead of the PID from 20 to 50 s
+static void test_mpc_tolerates_dead_time_error()
+{
+    const double dead[] = {20, 40, 50};
+    for (size_t i = 0; i < sizeof(dead) / sizeof(dead[0]); i++) {
+        Result pid = run(PID_ONLY, dead[i]);
+        Result mpc = run(MPC, dead[i]);
+        printf("dead time %2.0f s: IAE PID %3.0f F h, MPC %3.0f F h\n", dead[i], pid.iae, mpc.iae);
+        TEST_ASSERT_TRUE(mpc.iae < pid.iae);
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_mpc_tracks_closest);
+    RUN_TEST(test_mpc_tolerates_dead_time_error);
+    return UNITY_END();
+}
@@ -0,0 +1,390 @@
+// MqttClient against an in-memory broker: session flags, the QoS 1
+// window, resends after a dead link and the keepalive.
+#include <unity.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "mqtt.cpp"
+
+#define PACKET_CONNECT 0x10
+#define PACKET_PUBLISH 0x30
+#define PACKET_PINGREQ 0xc0
+
+struct Packet {
+    uint8_t              header;
+    std::vector<uint8_t> body;
+
+    uint8_t  type() const { return header & 0xf0; }
+    bool     dup() const { return header & 0x08; }
+    uint8_t  qos() const { return (header >> 1) & 3; }
+    uint16_t topicLen() const { return (body[0] << 8) | body[1]; }
+    uint16_t id() const { return (body[2 + topicLen()] << 8) | body[3 + topicLen()]; }
+    std::string topic() const { return std::string(body.begin() + 2, body.begin() + 2 + topicLen()); }
+    std::string payload() const { return std::string(body.begin() + 4 + topicLen(), body.end()); }
+};
+
+// the broker end of the socket: every complete packet the client writes is
+// decoded into received and answered the way the flags below say
+class FakeBroker : public Client
+{
+  public:
+    FakeBroker() : reachable(true), connackCode(0), ackPublish(true), answerPing(true), room(1024), up(false), dials(0)
+    {
+    }
+
+    int connect(const char *, uint16_t)
+    {
+        dials++;
+        up = reachable;
+        in.clear();
+        pendingOut.clear();
+        return up;
+    }
+
+    size_t write(const uint8_t *buf, size_t size)
+    {
+        pendingOut.insert(pendingOut.end(), buf, buf + size);
+        parse();
+        return size;
+    }
+
+    int     availableForWrite() { return up ? room : 0; }
+    int     available() { return in.size(); }
+    uint8_t connected() { return up; }
+    void    stop() { up = false; }
+
+    int read()
+    {
+        if (in.empty()) {
+            return -1;
+        }
+        int b = in.front();
+        in.pop_front();
+        return b;
+    }
+
+    std::vector<Packet> of(uint8_t type) const
+    {
+        std::vector<Packet> found;
+        for (size_t i = 0; i < received.size(); i++) {
+            if (received[i].type() == type) {
+                found.push_back(received[i]);
+            }
+        }
+        return found;
+    }
+
+    void ack(uint16_t id)
+    {
+        uint8_t puback[] = { 0x40, 2, (uint8_t) (id >> 8), (uint8_t) id };
+        in.insert(in.end(), puback, puback + sizeof(puback));
+    }
+
+    bool                reachable;
+    uint8_t             connackCode;
+    bool                ackPublish;
+    bool                answerPing;
+    int                 room;
+    bool                up;
+    int                 dials;
+    std::vector<Packet> received;
+    std::deque<uint8_t> in;
+
+  private:
+    void parse()
+    {
+        for (;;) {
+            size_t   i = 1, len = 0, shift = 0;
+            uint8_t  b;
+            do {
+                if (i >= pendingOut.size()) {
+                    return;
+                }
+                b = pendingOut[i++];
+                len |= (size_t) (b & 0x7f) << shift;
+                shift += 7;
+            } while (b & 0x80);
+            if (pendingOut.size() < i + len) {
+                return;
+            }
+            Packet p;
+            p.header = pendingOut[0];
+            p.body.assign(pendingOut.begin() + i, pendingOut.begin() + i + len);
+            pendingOut.erase(pendingOut.begin(), pendingOut.begin() + i + len);
+            received.push_back(p);
+            answer(p);
+        }
+    }
+
+    void answer(const Packet &p)
+    {
+        if (p.type() == PACKET_CONNECT) {
+            uint8_t connack[] = { 0x20, 2, 0, connackCode };
+            in.insert(in.end(), connack, connack + sizeof(connack));
+        } else if (p.type() == PACKET_PUBLISH && ackPublish) {
+            ack(p.id());
+        } else if (p.type() == PACKET_PINGREQ && answerPing) {
+            uint8_t pingresp[] = { 0xd0, 0 };
+            in.insert(in.end(), pingresp, pingresp + sizeof(pingresp));
+        }
+    }
+
+    std::vector<uint8_t> pendingOut;
+};
+
+static const char TOPIC[] = "bge/abc/s";
+
+static bool publish(MqttClient &mqtt, const char *text)
+{
+    return mqtt.publish(TOPIC, (const uint8_t *) text, strlen(text));
+}
+
+// connect and take the CONNACK
+static void bringUp(MqttClient &mqtt)
+{
+    mqtt.loop();
+    mqtt.loop();
+}
+
+// runs loop() at 100 ms steps for ms
+static void runFor(MqttClient &mqtt, unsigned long ms)
+{
+    for (unsigned long t = 0; t < ms; t += 100) {
+        hostAdvance(100);
+        mqtt.loop();
+    }
+}
+
+void setUp()
+{
+    hostMillis() = 100000;
+}
+
+void tearDown()
+{
+}
+
+static void test_connect_keeps_the_session()
+{
+    FakeBroker broker;
+    MqttClient mqtt(broker);
+
+    mqtt.begin("broker", 1883, "bge-abc");
+    bringUp(mqtt);
+    TEST_ASSERT_TRUE(mqtt.connected());
+    TEST_ASSERT_EQUAL_UINT32(1, mqtt.stats().connects);
+
+    std::vector<Packet> connects = broker.of(PACKET_CONNECT);
+    TEST_ASSERT_EQUAL(1, connects.size());
+    const std::vector<uint8_t> &body = connects[0].body;
+    TEST_ASSERT_EQUAL_MEMORY("\0\4MQTT\4", &body[0], 7);
+    TEST_ASSERT_EQUAL_UINT8(0x00, body[7]); // clean session off
+    TEST_ASSERT_EQUAL_UINT16(MQTT_KEEPALIVE, (body[8] << 8) | body[9]);
+    TEST_ASSERT_EQUAL_STRING("bge-abc", std::string(body.begin() + 12, body.end()).c_str());
+}
+
+static void test_publish_is_qos1_and_released_by_puback()
+{
+    FakeBroker broker;
+    MqttClient mqtt(broker);
+
+    mqtt.begin("broker", 1883, "bge-abc");
+    bringUp(mqtt);
+    TEST_ASSERT_TRUE(publish(mqtt, "1000,450.0,150.0,31.2,450"));
+    TEST_ASSERT_EQUAL_UINT8(1, mqtt.inFlight());
+
+    std::vector<Packet> pubs = broker.of(PACKET_PUBLISH);
+    TEST_ASSERT_EQUAL(1, pubs.size());
+    TEST_ASSERT_EQUAL_UINT8(1, pubs[0].qos());
+    TEST_ASSERT_FALSE(pubs[0].dup());
+    TEST_ASSERT_EQUAL_STRING(TOPIC, pubs[0].topic().c_str());
+    TEST_ASSERT_EQUAL_STRING("1000,450.0,150.0,31.2,450", pubs[0].payload().c_str());
+
+    mqtt.loop();
+    TEST_ASSERT_EQUAL_UINT8(0, mqtt.inFlight());
+    TEST_ASSERT_EQUAL_UINT32(1, mqtt.stats().acked);
+}
+
+// without acks the window fills and further samples are dropped, not
+// queued without bound or waited on
+static void test_window_is_bounded()
+{
+    FakeBroker broker;
+    MqttClient mqtt(broker);
+
+    mqtt.begin("broker", 1883, "bge-abc");
+    bringUp(mqtt);
+    broker.ackPublish = false;
+    for (int i = 0; i < MQTT_WINDOW; i++) {
+        TEST_ASSERT_TRUE(publish(mqtt, "s"));
+    }
+    TEST_ASSERT_FALSE(publish(mqtt, "s"));
+    TEST_ASSERT_EQUAL_UINT8(MQTT_WINDOW, mqtt.inFlight());
+    TEST_ASSERT_EQUAL_UINT32(1, mqtt.stats().dropped);
+
+    // acks out of order only free the window up to the oldest gap
+    std::vector<Packet> pubs = broker.of(PACKET_PUBLISH);
+    broker.ack(pubs[1].id());
+    mqtt.loop();
+    TEST_ASSERT_EQUAL_UINT8(MQTT_WINDOW, mqtt.inFlight());
+    broker.ack(pubs[0].id());
+    mqtt.loop();
+    TEST_ASSERT_EQUAL_UINT8(MQTT_WINDOW - 2, mqtt.inFlight());
+}
+
+// a PUBACK that never comes drops the link; the next session sends the
+// same packets again with DUP set, and their acks empty the window
+static void test_ack_timeout_resends_with_dup()
+{
+    FakeBroker broker;
+    MqttClient mqtt(broker);
+
+    mqtt.begin("broker", 1883, "bge-abc");
+    bringUp(mqtt);
+    broker.ackPublish = false;
+    publish(mqtt, "a");
+    publish(mqtt, "b");
+    publish(mqtt, "c");
+
+    runFor(mqtt, MQTT_TIMEOUT + 100);
+    TEST_ASSERT_FALSE(mqtt.connected());
+
+    broker.ackPublish = true;
+    runFor(mqtt, MQTT_RETRY_MIN + 200);
+    TEST_ASSERT_TRUE(mqtt.connected());
+    TEST_ASSERT_EQUAL(2, broker.of(PACKET_CONNECT).size());
+
+    std::vector<Packet> pubs = broker.of(PACKET_PUBLISH);
+    TEST_ASSERT_EQUAL(6, pubs.size());
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_FALSE(pubs[i].dup());
+        TEST_ASSERT_TRUE(pubs[3 + i].dup());
+        TEST_ASSERT_EQUAL_UINT16(pubs[i].id(), pubs[3 + i].id());
+        TEST_ASSERT_EQUAL_STRING(pubs[i].payload().c_str(), pubs[3 + i].payload().c_str());
+    }
+    mqtt.loop();
+    TEST_ASSERT_EQUAL_UINT8(0, mqtt.inFlight());
+    TEST_ASSERT_EQUAL_UINT32(3, mqtt.stats().resent);
+}
+
+// samples taken while the broker is away wait in the window and go out on
+// the next connect, without DUP since they were never sent
+static void test_offline_samples_wait_for_the_broker()
+{
+    FakeBroker broker;
+    MqttClient mqtt(broker);
+
+    broker.reachable = false;
+    mqtt.begin("broker", 1883, "bge-abc");
+    mqtt.loop();
+    TEST_ASSERT_FALSE(mqtt.connected());
+    publish(mqtt, "offline 1");
+    publish(mqtt, "offline 2");
+
+    broker.reachable = true;
+    runFor(mqtt, MQTT_RETRY_MIN + 200);
+    TEST_ASSERT_TRUE(mqtt.connected());
+    std::vector<Packet> pubs = broker.of(PACKET_PUBLISH);
+    TEST_ASSERT_EQUAL(2, pubs.size());
+    TEST_ASSERT_FALSE(pubs[0].dup());
+    TEST_ASSERT_EQUAL_STRING("offline 2", pubs[1].payload().c_str());
+    TEST_ASSERT_EQUAL_UINT32(0, mqtt.stats().resent);
+}
+
+// with no room in the socket the publish returns at once and the sample
+// goes out after the link is recycled
+static void test_full_socket_never_blocks()
+{
+    FakeBroker broker;
+    MqttClient mqtt(broker);
+
+    mqtt.begin("broker", 1883, "bge-abc");
+    bringUp(mqtt);
+    broker.room = 4;
+    TEST_ASSERT_TRUE(publish(mqtt, "backed up"));
+    TEST_ASSERT_EQUAL(0, broker.of(PACKET_PUBLISH).size());
+
+    broker.room = 1024;
+    runFor(mqtt, MQTT_TIMEOUT + MQTT_RETRY_MIN + 300);
+    std::vector<Packet> pubs = broker.of(PACKET_PUBLISH);
+    TEST_ASSERT_EQUAL(1, pubs.size());
+    TEST_ASSERT_FALSE(pubs[0].dup());
+    TEST_ASSERT_EQUAL_UINT8(0, mqtt.inFlight());
+}
+
+static void test_keepalive_ping_and_dead_link()
+{
+    FakeBroker broker;
+    MqttClient mqtt(broker);
+
+    mqtt.begin("broker", 1883, "bge-abc");
+    bringUp(mqtt);
+    runFor(mqtt, MQTT_KEEPALIVE * 500UL + 100);
+    TEST_ASSERT_EQUAL(1, broker.of(PACKET_PINGREQ).size());
+    TEST_ASSERT_TRUE(mqtt.connected());
+
+    broker.answerPing = false;
+    runFor(mqtt, MQTT_KEEPALIVE * 500UL + MQTT_TIMEOUT + 200);
+    TEST_ASSERT_EQUAL(2, broker.of(PACKET_PINGREQ).size());
+    TEST_ASSERT_FALSE(mqtt.connected());
+}
+
+static void test_refused_connack_drops()
+{
+    FakeBroker broker;
+    MqttClient mqtt(broker);
+
+    broker.connackCode = 5; // not authorised
+    mqtt.begin("broker", 1883, "bge-abc");
+    bringUp(mqtt);
+    TEST_ASSERT_FALSE(mqtt.connected());
+    TEST_ASSERT_FALSE(broker.up);
+    TEST_ASSERT_EQUAL_UINT32(0, mqtt.stats().connects);
+}
+
+// an unreachable broker is dialled with doubling gaps up to the cap
+static void test_reconnect_backs_off()
+{
+    FakeBroker broker;
+    MqttClient mqtt(broker);
+
+    broker.reachable = false;
+    mqtt.begin("broker", 1883, "bge-abc");
+    unsigned long gap = MQTT_RETRY_MIN;
+    mqtt.loop();
+    for (int i = 0; i < 10; i++) {
+        int dials = broker.dials;
+        runFor(mqtt, gap - 100);
+        TEST_ASSERT_EQUAL_INT(dials, broker.dials);
+        runFor(mqtt, 100);
+        TEST_ASSERT_EQUAL_INT(dials + 1, broker.dials);
+        gap = min(gap * 2, (unsigned long) MQTT_RETRY_MAX);
+    }
+
+    // a good session resets the backoff
+    broker.reachable = true;
+    runFor(mqtt, MQTT_RETRY_MAX + 100);
+    TEST_ASSERT_TRUE(mqtt.connected());
+    broker.stop();
+    mqtt.loop();
+    int dials = broker.dials;
+    runFor(mqtt, MQTT_RETRY_MIN);
+    TEST_ASSERT_EQUAL_INT(dials + 1, broker.dials);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_connect_keeps_the_session);
+    RUN_TEST(test_publish_is_qos1_and_released_by_puback);
+    RUN_TEST(test_window_is_bounded);
+    RUN_TEST(test_ack_timeout_resends_with_dup);
+    RUN_TEST(test_offline_samples_wait_for_the_broker);
+    RUN_TEST(test_full_socket_never_blocks);
+    RUN_TEST(test_keepalive_ping_and_dead_link);
+    RUN_TEST(test_refused_connack_drops);
+    RUN_TEST(test_reconnect_backs_off);
+    return UNITY_END();
+}
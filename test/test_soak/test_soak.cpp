@@ -0,0 +1,223 @@
+// A day of telemetry through the stock sinks and a run of text alerts,
+// against a scripted server, counting every heap allocation on the way,
+// and a minute against a server that never answers.
+// The periodic network path is meant to allocate nothing; one that does
+// fragments the ESP8266's small heap over a long cook.
+//
+// The largest free block is the heap allocator's on the device and has no
+// host equivalent; field 5 of the ThingSpeak channel and GET /api/health
+// report it from a real cook.
+#include <unity.h>
+
+#include <new>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "logstub.hpp"
+
+// the modules under test are built into each suite, see [env:native]
+#include "fixed.cpp"
+#include "history.cpp"
+#include "httppost.cpp"
+#include "sinks.cpp"
+#include "telemetry.cpp"
+
+History history;
+
+static unsigned sendsOk, sendsFailed;
+
+bool netCanSend()
+{
+    return true;
+}
+
+void netSendResult(bool ok)
+{
+    (ok ? sendsOk : sendsFailed)++;
+}
+
+// every operator new in the process goes through here
+static unsigned long allocations;
+
+void *operator new(size_t size)
+{
+    allocations++;
+    void *p = malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+// bytes malloc has handed out and not had back, where the C library says
+static size_t heapInUse()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+#define SOAKHOURS 24
+#define TEXTS     1000
+
+static HistorySink    historySink;
+static SerialCsvSink  serialSink;
+static ThingSpeakSink thingSpeakSink;
+
+// one control pass's sample, a steady cook with a little movement
+static void produce(unsigned long pass)
+{
+    TelemetrySample s = {};
+    s.dome            = (450 << TEMP_SHIFT) + (int16_t) (pass % 37);
+    s.meat            = (160 << TEMP_SHIFT) + (int16_t) (pass / 600 % 50);
+    s.target          = 450 << TEMP_SHIFT;
+    s.fan             = 2900 + pass % 200;
+    s.heapFree        = 30000 - pass % 100;
+    s.maxBlock        = 20000 - pass % 50;
+    telemetryProduce(s);
+}
+
+void setUp()
+{
+    if (telemetrySinkCount() == 0) {
+        telemetryAddSink(&historySink);
+        telemetryAddSink(&serialSink);
+        telemetryAddSink(&thingSpeakSink);
+    }
+}
+
+void tearDown()
+{
+}
+
+static void test_a_day_of_uploads_allocates_nothing()
+{
+    wifiServer.reply = "HTTP/1.1 200 OK\r\nContent-Length: 1\r\n\r\n1";
+
+    // the first upload's one-off costs are not the steady state's
+    unsigned long pass = 0;
+    for (; wifiServer.connects == 0; pass++) {
+        hostAdvance(CONTROLINTERVAL);
+        produce(pass);
+        telemetryLoop(true);
+    }
+
+    unsigned long before = allocations;
+    size_t        heap   = heapInUse();
+    size_t        peak   = heap;
+    unsigned long passes = pass + SOAKHOURS * 3600000UL / CONTROLINTERVAL;
+    for (; pass < passes; pass++) {
+        hostAdvance(CONTROLINTERVAL);
+        produce(pass);
+        telemetryLoop(true);
+        peak = max(peak, heapInUse());
+    }
+    // the last post's remaining steps
+    for (int i = 0; i < 4; i++) {
+        hostAdvance(CONTROLINTERVAL);
+        telemetryLoop(true);
+    }
+    unsigned uploads = wifiServer.connects;
+    printf("%u uploads over %d h: %lu allocations, peak heap %+ld bytes\n", uploads, SOAKHOURS,
+           allocations - before, (long) (peak - heap));
+
+    TEST_ASSERT_EQUAL_UINT32(0, allocations - before);
+    TEST_ASSERT_EQUAL_UINT32(heap, peak);
+    TEST_ASSERT_TRUE(uploads >= SOAKHOURS * 3600 / TSINTERVAL);
+    TEST_ASSERT_EQUAL_UINT32(uploads, sendsOk);
+
+    // and the last one was a whole request
+    TEST_ASSERT_TRUE(wifiServer.sentLen < sizeof(wifiServer.sent));
+    wifiServer.sent[wifiServer.sentLen] = '\0';
+    TEST_ASSERT_NOT_NULL(strstr(wifiServer.sent, "POST /update HTTP/1.1\r\n"));
+    TEST_ASSERT_NOT_NULL(strstr(wifiServer.sent, "&field1=451.1&field2="));
+    TEST_ASSERT_NOT_NULL(strstr(wifiServer.sent, "&field4=29910&field5=19960"));
+}
+
+// a server that takes the connection and never answers holds up neither
+// the pass nor the other sinks; the post gives up after HTTPTIMEOUT
+static void test_a_silent_server_holds_nothing_up()
+{
+    wifiServer.reply   = NULL;
+    wifiServer.stall   = true;
+    unsigned connects  = wifiServer.connects;
+    unsigned failed    = sendsFailed;
+    uint32_t overruns  = historySink.overruns + serialSink.overruns;
+    uint32_t delivered = historySink.delivered;
+    for (unsigned long pass = 0; pass < 600; pass++) {
+        hostAdvance(CONTROLINTERVAL);
+        produce(pass);
+        unsigned long before = millis();
+        telemetryLoop(true);
+        TEST_ASSERT_EQUAL_UINT32(before, millis());
+    }
+    wifiServer.stall = false;
+    printf("60 s against a silent server: %u posts, %u timed out\n", wifiServer.connects - connects,
+           sendsFailed - failed);
+
+    TEST_ASSERT_TRUE(wifiServer.connects - connects >= 60 / TSINTERVAL);
+    TEST_ASSERT_TRUE(sendsFailed - failed >= 60 / TSINTERVAL - 1);
+    TEST_ASSERT_EQUAL_UINT32(overruns, historySink.overruns + serialSink.overruns);
+    TEST_ASSERT_TRUE(historySink.delivered - delivered >= 59);
+}
+
+// the text path as bgemonitor.cpp's sendTextMessage() and loop() take it
+static void test_texts_allocate_nothing()
+{
+    static WiFiClient client;
+    static HttpPost   post(client);
+    char              number[32], text[96], body[160];
+
+    wifiServer.reply      = "HTTP/1.1 200 OK\r\n\r\n";
+    unsigned long before  = allocations;
+    size_t        heap    = heapInUse();
+    size_t        peak    = heap;
+    int           replies = 0;
+    for (int i = 0; i < TEXTS; i++) {
+        char message[48];
+        snprintf(message, sizeof(message), "Dome at %d F, meat at %d F & rising", 440 + i % 20, 150 + i % 50);
+        TEST_ASSERT_TRUE(urlEncode(number, sizeof(number), "4045551234") > 0);
+        TEST_ASSERT_TRUE(urlEncode(text, sizeof(text), message) > 0);
+        int n = snprintf(body, sizeof(body), "number=%s&message=%s", number, text);
+        TEST_ASSERT_TRUE(post.start("textbelt.com", "/text", body, n));
+        int status = HTTP_PENDING;
+        for (int step = 0; step < 10 && status == HTTP_PENDING; step++) {
+            status = post.poll();
+        }
+        replies += status == 200;
+        peak     = max(peak, heapInUse());
+    }
+    printf("%d texts: %lu allocations, peak heap %+ld bytes\n", TEXTS, allocations - before, (long) (peak - heap));
+
+    TEST_ASSERT_EQUAL_INT(TEXTS, replies);
+    TEST_ASSERT_EQUAL_UINT32(0, allocations - before);
+    TEST_ASSERT_EQUAL_UINT32(heap, peak);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_a_day_of_uploads_allocates_nothing);
+    RUN_TEST(test_a_silent_server_holds_nothing_up);
+    RUN_TEST(test_texts_allocate_nothing);
+    return UNITY_END();
+}
@@ -0,0 +1,138 @@
+// A reset two hours into a 450 F hold on a simulated kamado, and how far
+// the dome strays in the hour after: restored from the RTC checkpoint, from
+// the flash cook log after a power cycle, and started cold. Prints the
+// table.
+#include <unity.h>
+
+#include <stdio.h>
+
+#include "kamado.hpp"
+#include "logstub.hpp"
+#include "thermocouple.hpp"
+
+// the modules under test are built into each suite, see [env:native]
+#include "cooklog.cpp"
+#include "cookstate.cpp"
+#include "crc32.cpp"
+#include "domeloop.cpp"
+#include "domepid.cpp"
+#include "model.cpp"
+#include "mpc.cpp"
+
+// the firmware's controller state, owned by bgemonitor.cpp there
+double        domeTarget, domeTempF, fanOutput, pidOutput, domeReference, meatTempF;
+int16_t       domeTemp;
+unsigned long windowStartTime;
+DomePid       domePID(&domeTempF, &pidOutput, &domeReference, 4, 0.2, 1, DIRECT);
+
+double probeSafeOutput()
+{
+    return 0;
+}
+
+#define QUANTUM  0.45 // F, one MAX6675 count
+#define BOOTTIME 2000 // ms the fan is off while the chip restarts
+#define BAND     5.0  // F either side of the setpoint
+
+enum Restart { FROM_RTC, FROM_FLASH, COLD };
+
+static const char *const NAMES[] = {"RTC checkpoint", "flash cook log", "cold start"};
+
+// what setup() does, on whatever survived the reset
+static void boot(const Kamado &grill)
+{
+    domePID = DomePid(&domeTempF, &pidOutput, &domeReference, 4, 0.2, 1, DIRECT);
+    domeModel.reset();
+    fanOutput = pidOutput = 0;
+
+    domeTarget = 450;
+    domePID.SetOutputLimits(0, FANWINDOW);
+    domeAutomatic();
+    domePID.SetSampleTime(0);
+    domePID.SetDerivativeFilter(DERIVFILTER);
+
+    domeTempF = floor(grill.dome / QUANTUM) * QUANTUM;
+    domeTemp  = tempFromF(domeTempF);
+    meatTempF = grill.meat;
+    windowStartTime = millis();
+    cookStateBegin();
+}
+
+// controlTick and loop() for the given time, the dome range seen
+static void cook(Kamado &grill, double hours, double &lo, double &hi)
+{
+    const unsigned long passes  = hours * 3600000 / CONTROLINTERVAL;
+    const unsigned long perRead = KTCINTERVAL * KTC_DECIMATE / CONTROLINTERVAL;
+    const double        dt      = CONTROLINTERVAL / 1000.0;
+    for (unsigned long pass = 0; pass < passes; pass++) {
+        hostAdvance(CONTROLINTERVAL);
+        grill.step(fanOutput / FANWINDOW, dt);
+        bool fresh = pass % perRead == 0;
+        if (fresh) {
+            domeTempF = floor(grill.dome / QUANTUM) * QUANTUM;
+            domeTemp  = tempFromF(domeTempF);
+        }
+        domeControl(fresh, false, dt);
+        cookStateLoop();
+        lo = min(lo, grill.dome);
+        hi = max(hi, grill.dome);
+    }
+}
+
+static void run(Restart restart, double &lo, double &hi)
+{
+    Kamado grill;
+    double ignore = 0;
+
+    LittleFS.files.clear();
+    ESP.resetInfo.reason = REASON_DEFAULT_RST;
+    memset(ESP.rtcMemory, 0xa5, sizeof(ESP.rtcMemory));
+    boot(grill);
+    cookStateNew();
+    cook(grill, 2, ignore, ignore);
+
+    // a watchdog reset keeps RTC memory; a power cycle keeps only flash
+    if (restart == FROM_RTC) {
+        ESP.resetInfo.reason = REASON_SOFT_WDT_RST;
+    } else if (restart == COLD) {
+        LittleFS.files.clear();
+    }
+    for (unsigned long ms = 0; ms < BOOTTIME; ms += CONTROLINTERVAL) {
+        hostAdvance(CONTROLINTERVAL);
+        grill.step(0, CONTROLINTERVAL / 1000.0);
+    }
+    boot(grill);
+
+    lo = hi = grill.dome;
+    cook(grill, 1, lo, hi);
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_warm_restart_holds_the_dome()
+{
+    double lo[3], hi[3];
+    printf("reset 2 h into a 450 F hold, dome in the hour after\n");
+    for (int r = FROM_RTC; r <= COLD; r++) {
+        run((Restart) r, lo[r], hi[r]);
+        printf("  %-16s %6.1f .. %6.1f F\n", NAMES[r], lo[r], hi[r]);
+    }
+
+    TEST_ASSERT_TRUE(lo[FROM_RTC] > 450 - BAND && hi[FROM_RTC] < 450 + BAND);
+    TEST_ASSERT_TRUE(lo[FROM_FLASH] > 450 - BAND && hi[FROM_FLASH] < 450 + BAND);
+    // the cold start relearns the fan from nothing
+    TEST_ASSERT_TRUE(lo[COLD] < 450 - 4 * BAND);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_warm_restart_holds_the_dome);
+    return UNITY_END();
+}